@@ -0,0 +1,132 @@
+/**
+ *	\file		boucleEvt.h
+ *	\brief		Spécification de la boucle d'événements (epoll) multiplexant les sockets de dialogue
+ *	\author		Alexandre BREVIERE
+ *	\date		10 février 2026
+ *	\version	1.0
+ */
+#ifndef BOUCLE_EVT_H
+#define BOUCLE_EVT_H
+/*
+*****************************************************************************************
+ *	\noop		I N C L U D E S   S P E C I F I Q U E S
+ */
+#include "data.h"
+#include "minuterie.h"
+/*
+*****************************************************************************************
+ *	\noop		D E F I N I T I O N   DES   C O N S T A N T E S
+ */
+/**
+ *	\def		MAX_EVTS
+ *	\brief		Nombre maximal d'événements récupérés par appel à epoll_wait()
+ */
+#define MAX_EVTS	256
+/**
+ *	\def		DELAI_SONDE_MS
+ *	\brief		Silence d'un client au-delà duquel il est sondé (cf. reglerInactivite())
+ */
+#define DELAI_SONDE_MS			30000
+/**
+ *	\def		DELAI_INACTIVITE_MS
+ *	\brief		Silence d'un client au-delà duquel sa connexion est fermée
+ */
+#define DELAI_INACTIVITE_MS		90000
+/**
+ *	\def		RESOLUTION_INACTIVITE_MS
+ *	\brief		Précision des délais d'inactivité (tick de la roue des connexions)
+ */
+#define RESOLUTION_INACTIVITE_MS	250
+/*
+*****************************************************************************************
+ *	\noop		S T R C T U R E S   DE   D O N N E E S
+ */
+/**
+ *	\struct		connexion
+ *	\brief		Etat d'une connexion cliente multiplexée par la boucle d'événements
+ *	\note		La structure reste volontairement petite : le tampon de réassemblage n'est
+ *				alloué que lorsqu'un message est reçu en plusieurs morceaux, les entrées de
+ *				la file d'émission au premier message que le client tarde à lire
+ */
+struct connexion {
+	socket_t sock;		/**< socket de dialogue (adresse stable tant que la connexion vit)	*/
+	char *rx;			/**< début de message incomplet, NULL si aucun						*/
+	int rxLen;			/**< nombre d'octets en attente dans rx							*/
+	int fermee;			/**< positionné par l'application si elle a fermé sock.fd		*/
+	void *data;			/**< donnée libre associée par l'application					*/
+	minuteur_t inactivite;	/**< échéance de la prochaine vérification d'inactivité	*/
+	uint64_t activite;	/**< instant (ms) de la dernière lecture						*/
+	uint64_t sondee;	/**< instant (ms) de la dernière sonde envoyée					*/
+	int occupee;		/**< 1 tant qu'un travailleur sert la connexion (pool)			*/
+	fileEmission_t tx;	/**< file d'émission de sock, vidée sur EPOLLOUT				*/
+};
+/**
+ *	\typedef	connexion_t
+ *	\brief		Définition du type de données connexion_t
+ */
+typedef struct connexion connexion_t;
+/**
+ *	\typedef	pFctMess
+ *	\brief		Traitement d'un message complet reçu sur une connexion
+ *	\note		len : nombre d'octets du message (en-tête TRAME_LONGUEUR exclu)
+ */
+typedef void (*pFctMess) (connexion_t *cnx, char *msg, int len);
+/**
+ *	\typedef	pFctCnx
+ *	\brief		Traitement appelé à la fermeture d'une connexion par le client
+ *	\note		La fonction est responsable de la fermeture de cnx->sock.fd
+ */
+typedef void (*pFctCnx) (connexion_t *cnx);
+/*
+*****************************************************************************************
+ *	\noop		P R O T O T Y P E S   DES   F O N C T I O N S
+ */
+/**
+ *	\fn			void reglerInactivite(int delaiSondeMs, int delaiInactiviteMs, pFctCnx sonder)
+ *	\brief		Délais de surveillance des connexions (à appeler avant lancerBoucles/lancerPool)
+ *	\param 		delaiSondeMs : silence au-delà duquel sonder est appelée (une fois par silence)
+ *	\param 		delaiInactiviteMs : silence au-delà duquel la connexion est fermée comme
+ *				si le client l'avait fermée (fermer est appelée), 0 pour ne jamais fermer
+ *	\param 		sonder : envoi d'un message de vie applicatif, auquel le client répond ;
+ *				NULL pour ne pas sonder. Elle n'est appelée que si rien n'est en attente
+ *				d'émission sur la socket et jamais en même temps que traiter
+ *	\note		Par défaut : DELAI_SONDE_MS, DELAI_INACTIVITE_MS et pas de sonde
+ */
+void reglerInactivite(int delaiSondeMs, int delaiInactiviteMs, pFctCnx sonder);
+/**
+ *	\fn			void reglerEmission(int seuilLent, int seuilMax)
+ *	\brief		Seuils des files d'émission des connexions (à appeler avant lancerBoucles/lancerPool)
+ *	\param 		seuilLent : octets en attente au-delà desquels le client est signalé lent
+ *				(cf. emissionLente())
+ *	\param 		seuilMax : octets en attente au-delà desquels le client est abandonné
+ *	\note		Les envois vers les connexions ne bloquent jamais : un client qui ne lit plus
+ *				ne retient ni le thread émetteur ni les autres destinataires d'une diffusion.
+ *				Par défaut : SEUIL_LENT_EMISSION et SEUIL_MAX_EMISSION
+ */
+void reglerEmission(int seuilLent, int seuilMax);
+/**
+ *	\fn			void lancerBoucles(socket_t sockEcoute, int nbThreads, pFctMess traiter, pFctCnx fermer)
+ *	\brief		Multiplexe toutes les connexions acceptées sur sockEcoute avec nbThreads
+ *				boucles epoll, chacune acceptant et servant ses propres clients
+ *	\param 		sockEcoute : socket d'écoute (passée en mode non bloquant)
+ *	\param 		nbThreads : nombre de boucles, 0 pour une boucle par cœur
+ *	\param 		traiter : fonction appelée pour chaque message complet reçu
+ *	\param 		fermer : fonction appelée à la déconnexion d'un client, NULL pour un simple close()
+ *	\note		Ne rend pas la main
+ */
+void lancerBoucles(socket_t sockEcoute, int nbThreads, pFctMess traiter, pFctCnx fermer);
+/**
+ *	\fn			void lancerPool(socket_t sockEcoute, int nbTravailleurs, pFctMess traiter, pFctCnx fermer)
+ *	\brief		Sert les connexions acceptées sur sockEcoute avec un pool fixe de travailleurs
+ *	\param 		sockEcoute : socket d'écoute (passée en mode non bloquant)
+ *	\param 		nbTravailleurs : nombre de travailleurs, 0 pour un travailleur par cœur
+ *	\param 		traiter : fonction appelée pour chaque message complet reçu
+ *	\param 		fermer : fonction appelée à la déconnexion d'un client, NULL pour un simple close()
+ *	\note		Le thread appelant accepte les connexions et surveille celles au repos ; chaque
+ *				connexion prête devient une tâche déposée dans la file d'un travailleur, les
+ *				travailleurs inoccupés volent les tâches les plus anciennes des autres files.
+ *				Aucun thread n'est créé ni aucune mémoire allouée par l'acceptation. Ne rend pas la main
+ */
+void lancerPool(socket_t sockEcoute, int nbTravailleurs, pFctMess traiter, pFctCnx fermer);
+
+#endif /* BOUCLE_EVT_H */
@@ -0,0 +1,86 @@
+/**
+ * @file coroutine.h
+ * @brief Minimal stackful coroutines (ucontext) to suspend sequential game code
+ * @details A coroutine runs a function on its own stack until it calls coYield(),
+ *          which returns to whoever called coResume(). The engine's prompts
+ *          (askTakeAtout, askTakeAtoutTurn2, askCard) yield when called from a
+ *          coroutine: game() keeps its sequential structure while an event loop
+ *          drives thousands of suspended tables, resuming each one when the reply
+ *          of its player arrives. Coroutines never migrate: a coroutine must be
+ *          resumed by the thread that started it.
+ * @author Raphael ALLO
+ * @date 17/02/2026
+ */
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <ucontext.h>
+
+// ==================== CONSTANTS =============================================
+
+#define CO_STACK_SIZE (32 * 1024)    ///< Default stack size of a coroutine (bytes)
+
+// ==================== STRUCTURES ============================================
+
+/**
+ * @struct coroutine
+ * @brief A coroutine, its stack and the contexts switched by coResume/coYield
+ * @details ucontext only starts the coroutine on its stack; every later switch is a
+ *          _setjmp/_longjmp, which unlike swapcontext does not save the signal mask
+ *          (no system call per switch).
+ */
+typedef struct coroutine {
+    ucontext_t start;           ///< Initial context, on the coroutine's stack
+    jmp_buf ctx;                ///< Where the coroutine is suspended
+    jmp_buf caller;             ///< Where coResume waits for the next coYield
+    bool started;               ///< false until the first coResume
+    void *stack;                ///< Stack of the coroutine
+    void (*fn)(void *arg);      ///< Body of the coroutine
+    void *arg;                  ///< Argument of the body
+    void *value;                ///< Value exchanged by coResume/coYield
+    bool done;                  ///< true once the body has returned
+} coroutine_t;
+
+// ==================== FUNCTION PROTOTYPES ===================================
+
+/**
+ * @brief Prepares a coroutine, the body starts at the first coResume
+ * @param[out] co Coroutine to prepare
+ * @param[in] fn Body of the coroutine
+ * @param[in] arg Argument of the body
+ * @param[in] stackSize Stack size in bytes (0 for CO_STACK_SIZE)
+ */
+void coInit(coroutine_t *co, void (*fn)(void *arg), void *arg, size_t stackSize);
+
+/**
+ * @brief Runs a coroutine until it yields or returns
+ * @param[in,out] co Coroutine not yet done
+ * @param[in] value Value returned to the coroutine by its coYield
+ * @return Value given to coYield, NULL once the coroutine is done
+ */
+void *coResume(coroutine_t *co, void *value);
+
+/**
+ * @brief Suspends the current coroutine and returns to coResume
+ * @param[in] value Value returned by coResume
+ * @return Value given to the next coResume
+ */
+void *coYield(void *value);
+
+/**
+ * @brief Coroutine running on the calling thread
+ * @return The coroutine, NULL outside of any coroutine
+ */
+coroutine_t *coSelf(void);
+
+/**
+ * @brief Frees the stack of a coroutine (done, or never to be resumed)
+ * @param[in,out] co Coroutine
+ */
+void coFree(coroutine_t *co);
+
+#endif // COROUTINE_H
@@ -11,6 +11,8 @@
 *****************************************************************************************
  *	\noop		I N C L U D E S   S P E C I F I Q U E S
  */
+#include <pthread.h>
+#include <sys/uio.h>
 #include "session.h"
 /*
 *****************************************************************************************
@@ -21,6 +23,71 @@
  *	\brief		taille d'un buffer_t d'émission/réception
  */
 #define MAX_BUFFER	1024
+/**
+ *	\def		TRAME_TEXTE
+ *	\brief		Délimitation STREAM par défaut : chaque message se termine par '\0'
+ */
+#define TRAME_TEXTE		0
+/**
+ *	\def		TRAME_LONGUEUR
+ *	\brief		Délimitation STREAM par en-tête : longueur du message sur 4 octets (ordre réseau)
+ */
+#define TRAME_LONGUEUR	1
+/**
+ *	\def		TAILLE_ENTETE
+ *	\brief		Taille de l'en-tête d'une trame TRAME_LONGUEUR
+ */
+#define TAILLE_ENTETE	4
+/**
+ *	\def		MESS_BIN
+ *	\brief		Bit de poids fort du premier octet d'un message binaire, un message texte
+ *				commence par un chiffre (cf. codecs de libRepReq)
+ */
+#define MESS_BIN		0x80
+/**
+ *	\def		MAX_RX_TRAME
+ *	\brief		Capacité du tampon de réassemblage d'une connexion
+ */
+#define MAX_RX_TRAME	(2*(MAX_BUFFER+TAILLE_ENTETE))
+/**
+ *	\def		MAX_LOT
+ *	\brief		Taille du tampon d'émission d'un lot de messages
+ */
+#define MAX_LOT			(16*1024)
+/**
+ *	\def		DELAI_EMISSION_MS
+ *	\brief		Attente maximale d'une socket non bloquante pleine avant d'abandonner l'envoi
+ */
+#define DELAI_EMISSION_MS	1000
+/**
+ *	\def		MAX_DIFFUSIONS_LIBRES
+ *	\brief		Nombre de tampons de diffusion conservés pour être réutilisés, au-delà ils
+ *				sont rendus au système
+ */
+#define MAX_DIFFUSIONS_LIBRES	256
+/**
+ *	\def		LOT_DGRAM
+ *	\brief		Nombre maximal de datagrammes par appel à sendmmsg()/recvmmsg()
+ */
+#define LOT_DGRAM		32
+/**
+ *	\def		SEUIL_LENT_EMISSION
+ *	\brief		Octets en attente dans une file d'émission au-delà desquels le client est
+ *				signalé lent (cf. emissionLente())
+ */
+#define SEUIL_LENT_EMISSION		(32*1024)
+/**
+ *	\def		SEUIL_MAX_EMISSION
+ *	\brief		Octets en attente dans une file d'émission au-delà desquels le client est
+ *				abandonné : sa socket est marquée morte et fermée par son propriétaire
+ */
+#define SEUIL_MAX_EMISSION		(256*1024)
+/**
+ *	\def		MAX_FILE_EMISSION
+ *	\brief		Nombre maximal de messages en attente dans une file d'émission (dépasser
+ *				ce nombre abandonne le client comme SEUIL_MAX_EMISSION)
+ */
+#define MAX_FILE_EMISSION		512
 /*
 *****************************************************************************************
  *	\noop		S T R C T U R E S   DE   D O N N E E S
@@ -37,9 +104,84 @@ typedef char buffer_t[MAX_BUFFER];
 typedef void * generic;
 /**
  *	\typedef	pFct
- *	\brief		pointer sur fonction générique à 2 parametres génériques
+ *	\brief		pointer sur fonction de serialisation à 2 parametres génériques
+ *	\note		La fonction retourne la longueur du message produit ('\0' final compris pour
+ *				un message texte) : seul le codec connaît le format de ses messages
+ */
+typedef int (*pFct) (generic, generic);
+/**
+ *	\typedef	pFctDeSerial
+ *	\brief		pointer sur fonction de dé-serialisation : message reçu, nombre d'octets
+ *				reçus, requête/réponse à remplir
+ *	\note		Le message n'est lu que dans la limite des octets reçus
+ */
+typedef int (*pFctDeSerial) (const char *, int, generic);
+/**
+ *	\struct		rxTrame
+ *	\brief		Tampon de réassemblage des messages STREAM d'une connexion
+ *	\note		Alloué au premier recevoir() en mode TRAME_LONGUEUR
+ */
+struct rxTrame {
+	int len;					/**< nombre d'octets reçus non encore consommés	*/
+	char buff[MAX_RX_TRAME];	/**< octets reçus								*/
+};
+/**
+ *	\typedef	rxTrame_t
+ *	\brief		Définition du type de données rxTrame_t
+ */
+typedef struct rxTrame rxTrame_t;
+/**
+ *	\struct		diffusion
+ *	\brief		Message sérialisé une seule fois pour plusieurs destinataires
+ *	\note		Le tampon est partagé : chaque détenteur (émetteur, file d'émission d'une
+ *				connexion) possède une référence et la rend quand il n'en a plus besoin ;
+ *				le dernier la remet dans la réserve de tampons libres
+ */
+struct diffusion {
+	int refs;					/**< nombre de références (accès atomiques)		*/
+	int len;					/**< longueur du message, en-tête non compris	*/
+	struct diffusion *suiv;		/**< chaînage dans la réserve des tampons libres	*/
+	char trame[TAILLE_ENTETE + MAX_BUFFER];	/**< en-tête TRAME_LONGUEUR puis message	*/
+};
+/**
+ *	\typedef	diffusion_t
+ *	\brief		Définition du type de données diffusion_t
+ */
+typedef struct diffusion diffusion_t;
+/**
+ *	\struct		entreeEmission
+ *	\brief		Reste d'un message à émettre : une référence sur son tampon de diffusion
  */
-typedef void (*pFct) (generic, generic);
+struct entreeEmission {
+	diffusion_t *diff;			/**< tampon du message (une référence détenue)	*/
+	int deb;					/**< prochain octet à émettre dans diff->trame	*/
+	int fin;					/**< fin du message dans diff->trame			*/
+};
+/**
+ *	\struct		fileEmission
+ *	\brief		File d'émission d'une socket STREAM non bloquante
+ *	\note		Un envoi n'attend jamais le pair : ce que le noyau n'accepte pas tout de
+ *				suite est mis en file (sans copie pour une diffusion) et émis par
+ *				viderFileEmission() quand la socket redevient inscriptible. Les entrées ne
+ *				sont allouées qu'au premier message mis en file
+ */
+struct fileEmission {
+	pthread_mutex_t verrou;		/**< protège la file (émetteurs de plusieurs threads)	*/
+	struct entreeEmission *entrees;	/**< tampon circulaire de MAX_FILE_EMISSION entrées	*/
+	int deb;					/**< première entrée							*/
+	int nb;						/**< nombre d'entrées							*/
+	int octets;					/**< octets en attente (lecture atomique possible)	*/
+	int seuilLent;				/**< cf. SEUIL_LENT_EMISSION					*/
+	int seuilMax;				/**< cf. SEUIL_MAX_EMISSION						*/
+	int lente;					/**< 1 depuis le passage de seuilLent, jusqu'à la
+									 vidange de la moitié						*/
+	int fermee;					/**< 1 une fois la socket fermée : plus d'émission	*/
+};
+/**
+ *	\typedef	fileEmission_t
+ *	\brief		Définition du type de données fileEmission_t
+ */
+typedef struct fileEmission fileEmission_t;
 /*
 *****************************************************************************************
  *	\noop		P R O T O T Y P E S   DES   F O N C T I O N S
@@ -56,7 +198,7 @@ typedef void (*pFct) (generic, generic);
  */
 void envoyer(socket_t *sockEch, generic quoi, pFct serial, ...);
 /**
- *	\fn			void recevoir(socket_t *sockEch, generic quoi, pFct deSerial)
+ *	\fn			void recevoir(socket_t *sockEch, generic quoi, pFctDeSerial deSerial)
  *	\brief		Réception d'une requête/réponse sur une socket
  *	\param 		sockEch : socket d'échange à utiliser pour la réception
  *	\param 		quoi : requête/réponse reçue après dé-serialisation du buffer de réception
@@ -65,7 +207,199 @@ void envoyer(socket_t *sockEch, generic quoi, pFct serial, ...);
  *	\result		paramètre quoi modifié avec le requête/réponse reçue
  *				paramètre sockEch modifié pour le mode DGRAM
  */
-void recevoir(socket_t *sockEch, generic quoi, pFct deSerial);
+void recevoir(socket_t *sockEch, generic quoi, pFctDeSerial deSerial);
+/**
+ *	\fn			void envoyerLot(socket_t *sockEch, generic quoi[], int nb, pFct serial)
+ *	\brief		Envoi de plusieurs requêtes/réponses en un minimum d'appels à send()
+ *	\param 		sockEch : socket d'échange STREAM à utiliser pour l'envoi
+ *	\param 		quoi : tableau des requêtes/réponses à serialiser
+ *	\param 		nb : nombre d'éléments de quoi
+ *	\param 		serial : pointeur sur la fonction de serialisation d'une requête/réponse
+ *	\note		Les messages ne sont regroupés qu'en mode TRAME_LONGUEUR : en mode
+ *				TRAME_TEXTE le récepteur ne saurait pas les séparer
+ */
+void envoyerLot(socket_t *sockEch, generic quoi[], int nb, pFct serial);
+/**
+ *	\fn			int envoyerSts(socket_t *sockEch, generic quoi, pFct serial, ...)
+ *	\brief		Envoi d'une requête/réponse sans arrêt du processus en cas d'erreur
+ *	\param 		sockEch : socket d'échange à utiliser pour l'envoi
+ *	\param 		quoi : requête/réponse à serialiser avant l'envoi
+ *	\param 		serial : pointeur sur la fonction de serialisation d'une requête/réponse
+ *	\note		Mêmes paramètres qu'envoyer() ; une socket déjà morte n'est plus utilisée
+ *	\result		0, -1 en cas d'erreur : errno est positionné et sockEch->morte vaut 1
+ */
+int envoyerSts(socket_t *sockEch, generic quoi, pFct serial, ...);
+/**
+ *	\fn			int envoyerIov(socket_t *sockEch, const struct iovec parties[], int nb)
+ *	\brief		Envoi d'un message STREAM formé de plusieurs parties (en-tête applicatif,
+ *				corps sérialisé, charge partagée...) en un appel à sendmsg()
+ *	\param 		sockEch : socket d'échange STREAM
+ *	\param 		parties : morceaux du message, émis dans l'ordre sans être recopiés
+ *	\param 		nb : nombre de parties
+ *	\note		La longueur du message est la somme des iov_len : l'en-tête TRAME_LONGUEUR
+ *				est calculé sans strlen() ; en TRAME_TEXTE la dernière partie se termine
+ *				par '\0'. Aucune limite de taille à l'émission (listes, historiques), le
+ *				récepteur devant accepter des trames de cette taille (recevoir() : MAX_BUFFER).
+ *				Les parties peuvent être réutilisées au retour : ce que le noyau n'a pas
+ *				encore accepté est copié dans la file d'émission de la socket
+ *	\result		0, -1 en cas d'erreur : errno est positionné et sockEch->morte vaut 1
+ */
+int envoyerIov(socket_t *sockEch, const struct iovec parties[], int nb);
+/**
+ *	\fn			int recevoirSts(socket_t *sockEch, generic quoi, pFctDeSerial deSerial)
+ *	\brief		Réception d'une requête/réponse sans arrêt du processus en cas d'erreur
+ *	\param 		sockEch : socket d'échange à utiliser pour la réception
+ *	\param 		quoi : requête/réponse reçue après dé-serialisation du buffer de réception
+ *	\param 		deSerial : pointeur sur la fonction de dé-serialisation d'une requête/réponse
+ *	\result		0, -1 si la connexion est fermée par le pair ou en erreur : sockEch->morte
+ *				vaut alors 1 et quoi n'est pas modifié
+ */
+int recevoirSts(socket_t *sockEch, generic quoi, pFctDeSerial deSerial);
+/**
+ *	\fn			int envoyerLotSts(socket_t *sockEch, generic quoi[], int nb, pFct serial)
+ *	\brief		Envoi groupé sans arrêt du processus en cas d'erreur (cf. envoyerLot())
+ *	\result		0, -1 en cas d'erreur : errno est positionné et sockEch->morte vaut 1
+ */
+int envoyerLotSts(socket_t *sockEch, generic quoi[], int nb, pFct serial);
+/**
+ *	\fn			diffusion_t *creerDiffusion(generic quoi, pFct serial)
+ *	\brief		Sérialisation unique d'une requête/réponse destinée à plusieurs sockets
+ *	\param 		quoi : requête/réponse à serialiser
+ *	\param 		serial : pointeur sur la fonction de serialisation (NULL : chaîne de caractères)
+ *	\result		tampon pris dans la réserve, détenu par l'appelant (une référence)
+ *	\note		L'en-tête TRAME_LONGUEUR est calculé ici : le même tampon part tel quel
+ *				sur les sockets des deux délimitations
+ */
+diffusion_t *creerDiffusion(generic quoi, pFct serial);
+/**
+ *	\fn			diffusion_t *prendreDiffusion(diffusion_t *diff)
+ *	\brief		Ajoute une référence à un tampon de diffusion (nouveau détenteur)
+ *	\result		diff
+ */
+diffusion_t *prendreDiffusion(diffusion_t *diff);
+/**
+ *	\fn			void rendreDiffusion(diffusion_t *diff)
+ *	\brief		Rend une référence, le tampon retourne à la réserve après la dernière
+ */
+void rendreDiffusion(diffusion_t *diff);
+/**
+ *	\fn			int diffuser(diffusion_t *diff, socket_t *socks[], int nb)
+ *	\brief		Envoi d'un message déjà sérialisé sur plusieurs sockets STREAM
+ *	\param 		diff : message (l'appelant garde sa référence)
+ *	\param 		socks : sockets destinataires, les NULL sont ignorées
+ *	\param 		nb : nombre d'éléments de socks
+ *	\result		nombre de sockets servies ; une erreur ne marque morte que sa socket
+ *				(cf. envoyerSts()) sans interrompre la diffusion aux suivantes
+ *	\note		Une socket à file d'émission n'attend pas : ce qu'elle n'accepte pas tout de
+ *				suite est mis en file en référençant diff, le plus lent ne retarde personne
+ */
+int diffuser(diffusion_t *diff, socket_t *socks[], int nb);
+/**
+ *	\fn			int envoyerLotDGRAM(socket_t *sockEch, generic quoi[], const struct sockaddr_in dests[], int nb, pFct serial)
+ *	\brief		Envoi de plusieurs datagrammes, chacun vers son destinataire, par LOT_DGRAM
+ *				datagrammes par appel à sendmmsg()
+ *	\param 		sockEch : socket d'échange DGRAM
+ *	\param 		quoi : requêtes/réponses à serialiser
+ *	\param 		dests : destinataires, résolus une fois pour toutes (cf. adr2struct())
+ *	\param 		nb : nombre d'éléments de quoi et dests
+ *	\param 		serial : pointeur sur la fonction de serialisation (NULL : chaînes de caractères)
+ *	\result		nombre de datagrammes émis ; s'il est inférieur à nb, errno indique l'erreur
+ *				rencontrée sur quoi[résultat]
+ */
+int envoyerLotDGRAM(socket_t *sockEch, generic quoi[], const struct sockaddr_in dests[], int nb, pFct serial);
+/**
+ *	\fn			int diffuserDGRAM(socket_t *sockEch, diffusion_t *diff, const struct sockaddr_in dests[], int nb)
+ *	\brief		Envoi d'un message déjà sérialisé à plusieurs destinataires DGRAM
+ *	\param 		sockEch : socket d'échange DGRAM
+ *	\param 		diff : message (l'appelant garde sa référence), émis sans en-tête
+ *	\param 		dests : destinataires, résolus une fois pour toutes (cf. adr2struct())
+ *	\param 		nb : nombre d'éléments de dests
+ *	\result		nombre de destinataires servis (cf. envoyerLotDGRAM())
+ *	\note		Tous les datagrammes d'un appel à sendmmsg() pointent sur le même tampon
+ */
+int diffuserDGRAM(socket_t *sockEch, diffusion_t *diff, const struct sockaddr_in dests[], int nb);
+/**
+ *	\fn			int recevoirLotDGRAM(socket_t *sockEch, generic quoi[], struct sockaddr_in srcs[], int max, pFctDeSerial deSerial)
+ *	\brief		Réception de plusieurs datagrammes par appel à recvmmsg()
+ *	\param 		sockEch : socket d'échange DGRAM
+ *	\param 		quoi : requêtes/réponses reçues après dé-serialisation
+ *	\param 		srcs : expéditeurs des datagrammes reçus, NULL s'ils sont inutiles
+ *	\param 		max : nombre d'éléments de quoi et srcs
+ *	\param 		deSerial : pointeur sur la fonction de dé-serialisation (NULL : quoi[i] est
+ *				une chaîne de MAX_BUFFER octets)
+ *	\note		Attend le premier datagramme puis ne prend que ceux déjà arrivés : une rafale
+ *				est lue en max/LOT_DGRAM appels sans retarder un datagramme isolé.
+ *				sockEch->addrDst reçoit l'expéditeur du dernier datagramme (cf. recevoir())
+ *	\result		nombre de datagrammes reçus (au moins 1), -1 en cas d'erreur (errno positionné)
+ */
+int recevoirLotDGRAM(socket_t *sockEch, generic quoi[], struct sockaddr_in srcs[], int max, pFctDeSerial deSerial);
+/**
+ *	\fn			void initFileEmission(socket_t *sockEch, fileEmission_t *tx, int seuilLent, int seuilMax)
+ *	\brief		Passe une socket STREAM non bloquante en émission par file
+ *	\param 		sockEch : socket d'échange (non bloquante)
+ *	\param 		tx : file, allouée par l'appelant pour la durée de vie de la socket
+ *	\param 		seuilLent : cf. SEUIL_LENT_EMISSION (0 : valeur par défaut)
+ *	\param 		seuilMax : cf. SEUIL_MAX_EMISSION (0 : valeur par défaut)
+ *	\note		Tous les envois sur la socket passent ensuite par la file ; le propriétaire
+ *				appelle viderFileEmission() sur EPOLLOUT et fermerFileEmission() avant close()
+ */
+void initFileEmission(socket_t *sockEch, fileEmission_t *tx, int seuilLent, int seuilMax);
+/**
+ *	\fn			int viderFileEmission(socket_t *sockEch)
+ *	\brief		Emet ce que la socket accepte des messages en attente
+ *	\result		nombre d'octets encore en attente, -1 en cas d'erreur (errno positionné)
+ */
+int viderFileEmission(socket_t *sockEch);
+/**
+ *	\fn			void fermerFileEmission(socket_t *sockEch)
+ *	\brief		Abandonne les messages en attente, à appeler avant la fermeture de la socket
+ *	\note		Sans effet sur une socket sans file ; les envois suivants échouent (EPIPE)
+ */
+void fermerFileEmission(socket_t *sockEch);
+/**
+ *	\fn			int emissionLente(const socket_t *sockEch)
+ *	\brief		Indique si le client lit moins vite que le serveur ne lui écrit
+ *	\result		1 si la file d'émission a dépassé seuilLent (et n'est pas encore revenue à
+ *				sa moitié), 0 sinon
+ */
+int emissionLente(const socket_t *sockEch);
+/**
+ *	\fn			void modeTrame(socket_t *sockEch, int trame)
+ *	\brief		Choix de la délimitation des messages sur une socket STREAM
+ *	\param 		sockEch : socket d'échange
+ *	\param 		trame : TRAME_TEXTE ou TRAME_LONGUEUR
+ *	\note		Les deux extrémités doivent utiliser la même délimitation
+ */
+void modeTrame(socket_t *sockEch, int trame);
+/**
+ *	\fn			void libererTrame(socket_t *sockEch)
+ *	\brief		Libère le tampon de réassemblage d'une socket (à appeler à sa fermeture)
+ *	\param 		sockEch : socket d'échange
+ */
+void libererTrame(socket_t *sockEch);
+/**
+ *	\fn			int extraireTrame(const char *data, int len, int trame, char **msg)
+ *	\brief		Décodage du premier message complet d'une suite d'octets reçus
+ *	\param 		data : octets reçus
+ *	\param 		len : nombre d'octets de data
+ *	\param 		trame : délimitation utilisée (TRAME_TEXTE/TRAME_LONGUEUR)
+ *	\param 		msg : début du message dans data
+ *	\result		nombre d'octets consommés (en-tête compris), 0 si le message est incomplet,
+ *				-1 si la trame dépasse MAX_BUFFER
+ */
+int extraireTrame(const char *data, int len, int trame, char **msg);
+/**
+ *	\fn			int decoderTrames(const char *data, int len, int trame, char *msgs[], int max, int *consomme)
+ *	\brief		Décodage de tous les messages complets d'une suite d'octets reçus
+ *	\param 		data : octets reçus
+ *	\param 		len : nombre d'octets de data
+ *	\param 		trame : délimitation utilisée (TRAME_TEXTE/TRAME_LONGUEUR)
+ *	\param 		msgs : débuts des messages décodés dans data
+ *	\param 		max : nombre maximal de messages à décoder
+ *	\param 		consomme : nombre d'octets consommés par les messages décodés
+ *	\result		nombre de messages décodés, -1 si une trame dépasse MAX_BUFFER
+ */
+int decoderTrames(const char *data, int len, int trame, char *msgs[], int max, int *consomme);
 
 #endif /* DATA_H */
 
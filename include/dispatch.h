@@ -0,0 +1,115 @@
+/**
+ *	\file		dispatch.h
+ *	\brief		Spécification de la table de traitement des requêtes/réponses indexée par identifiant
+ *	\author		Alexandre BREVIERE
+ *	\date		12 février 2026
+ *	\version	1.0
+ */
+#ifndef DISPATCH_H
+#define DISPATCH_H
+/*
+*****************************************************************************************
+ *	\noop		I N C L U D E S   S P E C I F I Q U E S
+ */
+#include <stdio.h>
+#include "data.h"
+/*
+*****************************************************************************************
+ *	\noop		D E F I N I T I O N   DES   C O N S T A N T E S
+ */
+/**
+ *	\def		MAX_ID_REQ
+ *	\brief		Nombre d'identifiants de requêtes/réponses adressables par la table
+ *	\note		Les identifiants hors de [0, MAX_ID_REQ[ sont confiés au traitement par défaut
+ */
+#define MAX_ID_REQ	1024
+/*
+*****************************************************************************************
+ *	\noop		S T R C T U R E S   DE   D O N N E E S
+ */
+/**
+ *	\typedef	pFctTraiter
+ *	\brief		Traitement d'une requête/réponse reçue
+ *	\note		in : message reçu, ctx : contexte de l'appelant (socket...), out : message à émettre.
+ *				Les traitements ont exactement ce prototype et convertissent eux-mêmes leurs paramètres
+ */
+typedef void (*pFctTraiter) (generic in, generic ctx, generic out);
+/**
+ *	\struct		entreeDispatch
+ *	\brief		Entrée de la table : traitement associé à un identifiant et son profil
+ */
+struct entreeDispatch {
+	pFctTraiter traiter;			/**< traitement associé à l'identifiant		*/
+	const char *nom;				/**< nom du traitement (affichage)			*/
+	unsigned long nbAppels;			/**< nombre d'appels						*/
+	unsigned long long nsTotal;		/**< durée cumulée des appels (ns)			*/
+	unsigned long long nsMax;		/**< durée de l'appel le plus long (ns)		*/
+};
+/**
+ *	\typedef	entreeDispatch_t
+ *	\brief		Définition du type de données entreeDispatch_t
+ */
+typedef struct entreeDispatch entreeDispatch_t;
+/**
+ *	\struct		dispatch
+ *	\brief		Table des traitements d'un rôle (serveur, client...), indexée par identifiant
+ *	\note		La dernière entrée reçoit les identifiants hors table. Toutes les entrées ont un
+ *				traitement : l'appel ne teste jamais l'entrée
+ */
+struct dispatch {
+	entreeDispatch_t table[MAX_ID_REQ + 1];	/**< traitements et profils				*/
+	pFctTraiter defaut;						/**< traitement des identifiants inconnus	*/
+};
+/**
+ *	\typedef	dispatch_t
+ *	\brief		Définition du type de données dispatch_t
+ */
+typedef struct dispatch dispatch_t;
+/*
+*****************************************************************************************
+ *	\noop		P R O T O T Y P E S   DES   F O N C T I O N S
+ */
+/**
+ *	\fn			void initDispatch(dispatch_t *d, pFctTraiter defaut)
+ *	\brief		Initialise une table : tous les identifiants sont confiés au traitement par défaut
+ *	\param 		d : table
+ *	\param 		defaut : traitement des identifiants sans traitement enregistré, NULL pour les
+ *				ignorer silencieusement (ils restent comptés dans le profil)
+ */
+void initDispatch(dispatch_t *d, pFctTraiter defaut);
+/**
+ *	\fn			void enregistrerTraitement(dispatch_t *d, int id, const char *nom, pFctTraiter traiter)
+ *	\brief		Associe un traitement à un identifiant (à appeler au démarrage)
+ *	\param 		d : table
+ *	\param 		id : identifiant de la requête/réponse
+ *	\param 		nom : nom du traitement
+ *	\param 		traiter : traitement à appeler pour cet identifiant
+ */
+void enregistrerTraitement(dispatch_t *d, int id, const char *nom, pFctTraiter traiter);
+/**
+ *	\fn			void dispatcher(dispatch_t *d, int id, generic in, generic ctx, generic out)
+ *	\brief		Appelle le traitement associé à id et met à jour son profil
+ *	\param 		d : table
+ *	\param 		id : identifiant du message reçu
+ *	\param 		in : message reçu
+ *	\param 		ctx : contexte de l'appelant
+ *	\param 		out : message à émettre
+ */
+void dispatcher(dispatch_t *d, int id, generic in, generic ctx, generic out);
+/**
+ *	\fn			const entreeDispatch_t *statsTraitement(const dispatch_t *d, int id)
+ *	\brief		Profil du traitement associé à un identifiant
+ *	\param 		d : table
+ *	\param 		id : identifiant
+ *	\result		entrée de la table (entrée par défaut si id est hors table)
+ */
+const entreeDispatch_t *statsTraitement(const dispatch_t *d, int id);
+/**
+ *	\fn			void afficherStatsDispatch(const dispatch_t *d, FILE *fp)
+ *	\brief		Affiche le nombre d'appels et la latence de chaque traitement appelé
+ *	\param 		d : table
+ *	\param 		fp : flux de sortie
+ */
+void afficherStatsDispatch(const dispatch_t *d, FILE *fp);
+
+#endif /* DISPATCH_H */
@@ -0,0 +1,159 @@
+/**
+ * @file executeur.h
+ * @brief Table executors: many Belote tables multiplexed on a few threads
+ * @details Each table is pinned to one executor thread, chosen from its id. Players
+ *          (network threads, robots) never touch a table: they post actions to the
+ *          table's executor, which applies them in arrival order and reports the
+ *          result. A table is thus only ever accessed by one thread and the engine
+ *          needs no lock, while thousands of tables share a handful of cores.
+ *          Optional turn timers (execTurnTimers) bound how long a seat may think: each
+ *          executor keeps the deadlines of its tables in a timer wheel and plays for the
+ *          late player with a robot, so idle tables cost one wheel entry each.
+ * @author Raphael ALLO
+ * @date 16/02/2026
+ */
+
+#ifndef EXECUTEUR_H
+#define EXECUTEUR_H
+
+#include <pthread.h>
+#include "robots.h"
+#include "minuterie.h"
+
+// ==================== CONSTANTS =============================================
+
+#define TURN_RESOLUTION_MS 100      ///< Precision of the turn deadlines (tick of the executors' wheels)
+#define EXEC_INDEX_BITS 22          ///< Low bits of a table id: slot * nb executors + executor, the high bits count the reuses of the slot
+#define EXEC_NO_TABLE UINT32_MAX    ///< Id of no table (free slot)
+
+// ==================== ENUMERATIONS ==========================================
+
+/**
+ * @enum actionKind
+ * @brief Kind of an action posted to a table
+ */
+enum actionKind {
+    ACT_CREATE,     ///< Create the table (posted by execCreateTable)
+    ACT_BID,        ///< Bid of a player (take, color)
+    ACT_PLAY,       ///< Card played by a player (card)
+    ACT_CLOSE       ///< Destroy the table
+};
+
+// ==================== STRUCTURES ============================================
+
+/**
+ * @struct action
+ * @brief Message posted to a table, copied into the executor's mailbox
+ */
+typedef struct action {
+    enum actionKind kind;       ///< Kind of action
+    uint32_t table;             ///< Id of the table
+    int player;                 ///< Player who acts (ACT_BID, ACT_PLAY)
+    bool take;                  ///< ACT_BID: true to take
+    enum colorCard color;       ///< ACT_BID: suit chosen in the second round, NONE otherwise
+    enum card card;             ///< ACT_PLAY: card played
+    uint64_t seed;              ///< ACT_CREATE: seed of the table
+    bool automatic;             ///< Played by the executor for a player who ran out of time
+} action_t;
+
+/**
+ * @brief Result of an action, called on the executor thread of the table
+ * @param[in] ctx Context given to execStart
+ * @param[in] exec Number of the executor thread (0..nb-1), to index per-thread data
+ * @param[in] t Table after the action (valid during the call only), NULL after ACT_CLOSE
+ * @param[in] a Action applied
+ * @param[in] accepted false if the table refused the action (not the player's turn, illegal card...)
+ * @note The callback may read the table and post new actions, it must not modify the table
+ */
+typedef void (*execNotify_t)(void *ctx, int exec, const table_t *t, const action_t *a, bool accepted);
+
+/**
+ * @struct executor
+ * @brief One executor thread, its mailbox and its tables
+ */
+typedef struct executor {
+    pthread_t th;                   ///< Thread of the executor
+    int num;                        ///< Number of the executor
+    struct executors *pool;         ///< Pool of the executor
+    pthread_mutex_t lock;           ///< Protects the mailbox only
+    pthread_cond_t wake;            ///< Signaled when the mailbox becomes non empty
+    action_t *mailbox;              ///< Actions posted, not yet applied
+    int nbMail, capMail;            ///< Size and capacity of the mailbox
+    bool stop;                      ///< Set by execStop
+    table_t *tables;                ///< Tables of the executor (slot = low bits of the id / nb executors)
+    uint32_t *ids;                  ///< Id of the live table of each slot, EXEC_NO_TABLE if free
+    uint32_t capTables;             ///< Capacity of tables, ids and turns
+    uint32_t nbSlots;               ///< Slots handed out by execCreateTable (protected by lock)
+    uint32_t *freeIds;              ///< Next ids of the closed slots, to reuse (protected by lock)
+    uint32_t nbFree, capFree;       ///< Size and capacity of freeIds
+    minuteur_t *turns;              ///< Turn deadline of each table
+    roue_t wheel;                   ///< Turn deadlines of the executor's tables
+    rng_t rng;                      ///< Generator of the automatic player
+    long nbActions;                 ///< Actions applied (read after execStop)
+} __attribute__((aligned(64))) executor_t;
+
+/**
+ * @struct executors
+ * @brief Pool of executor threads
+ */
+typedef struct executors {
+    int nb;                         ///< Number of executors
+    executor_t *exec;               ///< Executors
+    uint32_t nextExec;              ///< Executor of the next table (round robin)
+    execNotify_t notify;            ///< Result callback
+    void *ctx;                      ///< Context of the callback
+    int bidMs;                      ///< Time allowed for a bid, 0 for no limit
+    int playMs;                     ///< Time allowed to play a card, 0 for no limit
+    const policy_t *autoPlayer;     ///< Robot playing for a late player
+} executors_t;
+
+// ==================== FUNCTION PROTOTYPES ===================================
+
+/**
+ * @brief Starts the executor threads
+ * @param[out] pool Pool to start
+ * @param[in] nb Number of threads, 0 for one per core
+ * @param[in] notify Result callback (may be NULL)
+ * @param[in] ctx Context given to the callback
+ */
+void execStart(executors_t *pool, int nb, execNotify_t notify, void *ctx);
+
+/**
+ * @brief Limits the time of each bid and card, the executor then plays for the late player
+ * @param[in,out] pool Pool of executors
+ * @param[in] bidMs Time allowed for a bid, 0 for no limit
+ * @param[in] playMs Time allowed to play a card, 0 for no limit
+ * @param[in] autoPlayer Robot deciding on timeout, NULL for "passif" (pass, cheapest card)
+ * @note To call after execStart and before the first execCreateTable. The deadline of a
+ *       table restarts at each accepted action; refused actions do not extend it. The
+ *       automatic move is applied like a posted one (automatic set) and notified.
+ */
+void execTurnTimers(executors_t *pool, int bidMs, int playMs, const policy_t *autoPlayer);
+
+/**
+ * @brief Creates a table on the next executor, in a closed slot if it has one
+ * @param[in,out] pool Pool of executors
+ * @param[in] seed Seed of the table (see tableInit)
+ * @return Id of the table, usable at once: the creation is queued before any other action
+ * @note The first deal is dealt as soon as the table is created
+ * @note The slot of a closed table is reused with a new id (generation in the high bits):
+ *       an action still carrying the old id is refused. Generations wrap after
+ *       2^(32 - EXEC_INDEX_BITS) reuses of the same slot.
+ */
+uint32_t execCreateTable(executors_t *pool, uint64_t seed);
+
+/**
+ * @brief Posts an action to the executor of its table (thread safe, never blocks on the engine)
+ * @param[in,out] pool Pool of executors
+ * @param[in] a Action, copied
+ * @note An action for a closed table is notified with no table and refused
+ */
+void execPost(executors_t *pool, const action_t *a);
+
+/**
+ * @brief Stops the executors once their mailboxes are empty and waits for them
+ * @param[in,out] pool Pool of executors
+ */
+void execStop(executors_t *pool);
+
+#endif // EXECUTEUR_H
@@ -1,44 +1,115 @@
+#include <stdint.h>
 #include "data.h"
 #include "users.h"
+#include "parties.h"
+#include "dispatch.h"
 
 //1 req2str(req,str)
 #define REQ_STR_OUT "%i:%s:%s" 
 
-//2 str2req(str,req)
-#define REQ_STR_IN "%i:%[^:]:%[^\n]" 
+//2 str2req(str,lg,req) : "id:verbe:option" lu dans les lg octets reçus, verbe et option
+//  vides admis, plus longs que verbReq/optReq refusés (idReq = -1)
 
 //3 rep2str(rep, str)
 #define REP_STR_OUT "%i:%s:%s"
 
-//4 str2rep(str rep)
-#define REP_STR_IN "%i:%[^:]:%[^\n]"
+//4 str2rep(str,lg,rep) : même format que str2req
+
+//5 codec binaire : version sur le 1er octet (bit MESS_BIN positionné)
+#define BIN_VERSION (MESS_BIN | 1)
+
+// codecs négociables sur une socket (socket_t.codec)
+#define CODEC_TEXTE 0
+#define CODEC_BINAIRE 1
+
+// négociation du codec : requête REQ_CODEC, optReq = nom du codec proposé
+#define REQ_CODEC 310
+#define NOM_CODEC_BINAIRE "BIN1"
+
+// message de vie : le serveur sonde un client muet, le client répond par REQ_SONDE
+#define REQ_SONDE 311
+
+// type de l'option d'une requête/réponse
+typedef enum {
+	OPT_TEXTE,		// optReq/optRep
+	OPT_CARTES,		// masque de cartes (bit n = carte n de enum card)
+	OPT_JOUEUR,		// indice d'un joueur
+	OPT_SCORES		// scores des deux équipes
+} typeOpt_t;
+
+// option typée, transmise sans conversion texte par le codec binaire
+typedef union {
+	uint32_t cartes;
+	uint8_t joueur;
+	struct { int32_t eq1; int32_t eq2; } scores;
+} optBin_t;
 
 typedef struct requete{
 	short idReq;
 	char verbReq[20];
 	char optReq[100]; // a modifier selon le protocole applicatif
+	char typeOpt;     // typeOpt_t : OPT_TEXTE si optReq est utilisé
+	optBin_t optBin;
 } requete_t;
 
 typedef struct reponse{
 	short idRep;
 	char verbRep[20];
 	char optRep[100]; // a modifier selon le protocole applicatif
+	char typeOpt;     // typeOpt_t : OPT_TEXTE si optRep est utilisé
+	optBin_t optBin;
 } reponse_t;
 
+// fonctions de (dé)serialisation d'un codec
+typedef struct codec{
+	pFct req2buf;
+	pFctDeSerial buf2req;
+	pFct rep2buf;
+	pFctDeSerial buf2rep;
+} codec_t;
+
 
 // prototype des fonctions
-void req2str(const requete_t * req, char * str);
-void str2req(const char * str, requete_t * req);
-void rep2str(const reponse_t * rep, char * str);
-void str2rep(const char * str, reponse_t * rep);
-
-void traiterReq101(requete_t * req);
-void traiterReq102(requete_t * req);
-void traiterReq103(requete_t * req);
+// req2buf/rep2buf retournent la longueur du message produit (cf. pFct),
+// buf2req/buf2rep ne lisent que les lg octets reçus (cf. pFctDeSerial)
+int req2str(const requete_t * req, char * str);
+int str2req(const char * str, int lg, requete_t * req);
+int rep2str(const reponse_t * rep, char * str);
+int str2rep(const char * str, int lg, reponse_t * rep);
+
+int req2bin(const requete_t * req, char * buf);
+int bin2req(const char * buf, int lg, requete_t * req);
+int rep2bin(const reponse_t * rep, char * buf);
+int bin2rep(const char * buf, int lg, reponse_t * rep);
+
+const codec_t * codecSocket(const socket_t * sockEch);
+int proposerCodec(socket_t * sockEch, int codec);
+void accepterCodec(socket_t * sockEch, const char * nomCodec);
+// côté client : répond à une sonde du serveur, retourne 1 si le message reçu d'identifiant
+// id en était une (à ignorer) ; une sonde se relit indifféremment en requête ou en réponse
+int repondreSonde(socket_t * sockEch, short id);
+// côté client : réception avec le codec de la socket, sondes répondues et sautées
+void recevoirReq(socket_t * sockEch, requete_t * req);
+void recevoirRep(socket_t * sockEch, reponse_t * rep);
+// côté serveur : sonde un client muet (cf. reglerInactivite())
+void sonderClient(socket_t * sockEch);
+// côté serveur : même requête à plusieurs clients (joueurs, spectateurs), sérialisée une
+// fois par codec utilisé ; retourne le nombre de clients servis (cf. diffuser())
+int diffuserReq(socket_t * socks[], int nb, const requete_t * req);
+
+// traitements du dialogue (cf. pFctTraiter) : in = requête reçue
+void traiterReq101(generic in, generic ctx, generic out);
+void traiterReq102(generic in, generic ctx, generic out);
+void traiterReq103(generic in, generic ctx, generic out);
 void traiterRep(reponse_t * rep);
 
 void DialSrv(socket_t sockEcoute);
 void DialC(socket_t sd);
 
 
+// enregistre les traitements de toutes les requêtes (à appeler au démarrage)
+void initTraitements(void);
+// traitement d'une requête reçue par le dialogue (DialC)
+void traiterDial(requete_t * req, socket_t * sDial);
+// requête à renvoyer au client, idReq vaut 0 s'il n'y a rien à renvoyer
 requete_t traiterRegister(reponse_t * rep, socket_t * sDial);
\ No newline at end of file
@@ -0,0 +1,110 @@
+/**
+ *	\file		minuterie.h
+ *	\brief		Spécification de la roue de minuteurs partagée par les connexions et les tables
+ *	\author		Alexandre BREVIERE
+ *	\date		17 février 2026
+ *	\version	1.0
+ */
+#ifndef MINUTERIE_H
+#define MINUTERIE_H
+/*
+*****************************************************************************************
+ *	\noop		I N C L U D E S   S P E C I F I Q U E S
+ */
+#include <stdint.h>
+/*
+*****************************************************************************************
+ *	\noop		D E F I N I T I O N   DES   C O N S T A N T E S
+ */
+/**
+ *	\def		NB_CASES_ROUE
+ *	\brief		Nombre de cases de la roue (puissance de 2) : un tour couvre
+ *				NB_CASES_ROUE * résolution ms, les échéances plus lointaines attendent
+ *				leur tour dans leur case
+ */
+#define NB_CASES_ROUE	1024
+/*
+*****************************************************************************************
+ *	\noop		S T R C T U R E S   DE   D O N N E E S
+ */
+/**
+ *	\typedef	minuteur_t
+ *	\brief		Minuteur intrusif : inclus dans l'objet surveillé, il n'alloue rien
+ */
+typedef struct minuteur minuteur_t;
+/**
+ *	\typedef	pFctMinuteur
+ *	\brief		Action d'un minuteur échu (le minuteur est désarmé, l'action peut le réarmer)
+ */
+typedef void (*pFctMinuteur) (minuteur_t *m, void *arg);
+/**
+ *	\struct		minuteur
+ *	\brief		Minuteur chaîné dans la case de son échéance
+ */
+struct minuteur {
+	minuteur_t *prec, *suiv;	/**< chaînage dans la case						*/
+	uint64_t echeance;			/**< tick d'expiration							*/
+	pFctMinuteur action;		/**< action à l'expiration						*/
+	void *arg;					/**< argument de l'action						*/
+	int arme;					/**< 1 si le minuteur est dans la roue			*/
+};
+/**
+ *	\struct		roue_t
+ *	\brief		Roue de minuteurs : armer et annuler sont en O(1), chaque tick ne parcourt
+ *				qu'une case
+ *	\note		La roue n'est pas protégée : son propriétaire la sert depuis un seul thread
+ *				ou sous son propre verrou
+ */
+typedef struct {
+	minuteur_t *cases[NB_CASES_ROUE];	/**< minuteurs par tick modulo NB_CASES_ROUE	*/
+	uint64_t origine;			/**< instant (ms) du tick 0						*/
+	uint64_t tick;				/**< dernier tick traité						*/
+	int resolution;				/**< durée d'un tick (ms)						*/
+	int nbArmes;				/**< nombre de minuteurs dans la roue			*/
+} roue_t;
+/*
+*****************************************************************************************
+ *	\noop		P R O T O T Y P E S   DES   F O N C T I O N S
+ */
+/**
+ *	\fn			uint64_t horlogeMs(void)
+ *	\brief		Horloge monotone grossière (ms), peu coûteuse à lire
+ */
+uint64_t horlogeMs(void);
+/**
+ *	\fn			void initRoue(roue_t *r, int resolutionMs)
+ *	\brief		Initialise une roue vide
+ *	\param 		r : roue
+ *	\param 		resolutionMs : durée d'un tick, précision des échéances
+ */
+void initRoue(roue_t *r, int resolutionMs);
+/**
+ *	\fn			void armerMinuteur(roue_t *r, minuteur_t *m, int delaiMs, pFctMinuteur action, void *arg)
+ *	\brief		Arme (ou réarme) un minuteur
+ *	\param 		r : roue
+ *	\param 		m : minuteur, déjà armé ou non
+ *	\param 		delaiMs : délai minimal avant l'expiration, compté depuis l'appel : le minuteur
+ *				expire au premier tick qui suit, soit au plus une résolution plus tard
+ *	\param 		action : action à l'expiration
+ *	\param 		arg : argument de l'action
+ */
+void armerMinuteur(roue_t *r, minuteur_t *m, int delaiMs, pFctMinuteur action, void *arg);
+/**
+ *	\fn			void annulerMinuteur(roue_t *r, minuteur_t *m)
+ *	\brief		Retire un minuteur de la roue (sans effet s'il n'est pas armé)
+ */
+void annulerMinuteur(roue_t *r, minuteur_t *m);
+/**
+ *	\fn			int avancerRoue(roue_t *r)
+ *	\brief		Déclenche les minuteurs échus depuis le dernier appel
+ *	\return		nombre de minuteurs déclenchés
+ */
+int avancerRoue(roue_t *r);
+/**
+ *	\fn			int delaiRoue(const roue_t *r)
+ *	\brief		Attente jusqu'au prochain tick à traiter, pour epoll_wait()
+ *	\return		délai en ms, -1 si aucun minuteur n'est armé
+ */
+int delaiRoue(const roue_t *r);
+
+#endif /* MINUTERIE_H */
@@ -13,7 +13,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 // ==================== CONSTANTS =============================================
 
@@ -78,6 +80,19 @@ enum state {
 
 // ==================== STRUCTURES ============================================
 
+/**
+ * @typedef cardSet_t
+ * @brief Set of cards held as a 32-bit mask: bit n stands for card n of enum card
+ * @details Each suit occupies one byte (Hearts in bits 0-7, Clubs 8-15, Spades 16-23,
+ *          Diamonds 24-31), so suit extraction is a shift/mask
+ */
+typedef uint32_t cardSet_t;
+
+#define CARD_BIT(card)      ((cardSet_t)1 << (card))            ///< Set holding only this card
+#define SUIT_MASK(color)    ((cardSet_t)0xFF << ((color) * 8))  ///< Set of the 8 cards of a suit
+#define HAS_CARD(set, card) (((set) >> (card)) & 1)             ///< true if card is in set
+#define NB_CARDS(set)       __builtin_popcount(set)             ///< Number of cards in set
+
 /**
  * @struct player
  * @brief Structure representing a player
@@ -85,14 +100,14 @@ enum state {
 typedef struct player {
     int num;                    ///< Player number (0-3)
     enum state s;               ///< Current player state
-    int cards[NB_CARD_HAND];    ///< Cards in player's hand
+    cardSet_t cards;            ///< Cards in player's hand
 } player_t;
 
 /**
  * @typedef players_t
- * @brief Array of pointers to all players in the game
+ * @brief Array of all players at a table
  */
-typedef player_t* players_t[PLAYERS_MAX];
+typedef player_t players_t[PLAYERS_MAX];
 
 /**
  * @struct pileCard
@@ -109,42 +124,119 @@ typedef struct pileCard {
  */
 typedef enum card pli_t[PLAYERS_MAX];
 
+/**
+ * @struct rng
+ * @brief State of a PCG32 random generator (64-bit LCG with a permuted 32-bit output)
+ * @details Each table owns its generator: shuffles never share state or take a lock
+ */
+typedef struct rng {
+    uint64_t state;             ///< LCG state
+    uint64_t inc;               ///< Stream selector (always odd)
+} rng_t;
+
+/**
+ * @enum phase
+ * @brief Step of a table's state machine
+ */
+enum phase {
+    PHASE_DEAL,     ///< Waiting for tableDeal() to start a round
+    PHASE_BID1,     ///< First bidding round (take the revealed card's suit)
+    PHASE_BID2,     ///< Second bidding round (choose the trump suit)
+    PHASE_PLAY,     ///< Tricks are being played
+    PHASE_END       ///< A team reached POINT_WIN
+};
+
+/**
+ * @struct table
+ * @brief Complete state of one game of Belote
+ * @details The engine keeps no global state: every function works on the table it is
+ *          given, so one process can drive any number of tables, each step by step
+ *          (tableDeal, tableBid, tablePlay) from its own event loop.
+ */
+typedef struct table {
+    enum phase phase;           ///< Current step of the game
+    players_t players;          ///< The 4 players and their hands
+    int nbPlayer;               ///< Number of players seated
+    pileCard_t deck;            ///< Deck of the current round
+    cardSet_t piles[2];         ///< Cards won by each team (indexed by enum equipe)
+    pli_t pli;                  ///< Current trick, in play order
+    int nbCardPli;              ///< Number of cards in the current trick
+    int nbPli;                  ///< Number of tricks played in the round
+    enum card retourne;         ///< Revealed card during the bidding
+    int dealer;                 ///< First player to bid and to lead in the round
+    int startPlayer;            ///< Player who led the current trick
+    int toAct;                  ///< Player expected to bid or play
+    int nbPass;                 ///< Consecutive passes in the current bidding round
+    int taker;                  ///< Player who took, -1 if none
+    enum colorCard trump;       ///< Trump suit, NONE during the bidding
+    int scores[2];              ///< Score of each team (indexed by enum equipe)
+    rng_t rng;                  ///< Table's generator, draws the seed of each deal
+    uint64_t dealSeed;          ///< Seed of the current deal (replay with tableDealSeed)
+    int nbDeal;                 ///< Number of deals since tableInit
+} table_t;
+
+/**
+ * @enum promptKind
+ * @brief Question asked to a player by a table run in a coroutine
+ */
+enum promptKind {
+    PROMPT_BID1,    ///< askTakeAtout: reply in take
+    PROMPT_BID2,    ///< askTakeAtoutTurn2: reply in take and color
+    PROMPT_CARD     ///< askCard: reply in card, chosen in legal
+};
+
+/**
+ * @struct prompt
+ * @brief Question yielded by a table's coroutine, the driver fills in the reply
+ * @details game() run inside a coroutine (see coroutine.h) yields a prompt_t* at each
+ *          ask*. The driver sends the question to the player, stores the reply here
+ *          once it arrives and resumes the coroutine, which carries on with it.
+ */
+typedef struct prompt {
+    enum promptKind kind;       ///< Question asked
+    int player;                 ///< Player asked
+    cardSet_t legal;            ///< PROMPT_CARD: cards the player may play
+    bool take;                  ///< Reply to PROMPT_BID1/PROMPT_BID2
+    enum colorCard color;       ///< Reply to PROMPT_BID2: suit chosen
+    enum card card;             ///< Reply to PROMPT_CARD: card played
+} prompt_t;
+
 // ==================== FUNCTION PROTOTYPES ===================================
 
 // -------------------- Communication Functions -------------------------------
 
 /**
  * @brief Adds a new player to the game
- * @param[in,out] players Array of player pointers
+ * @param[in,out] players Array of players
  * @param[in,out] nbPlayer Current number of players, incremented if successful
- * @return true if player was added successfully, false if game is full or allocation failed
+ * @return true if player was added successfully, false if game is full
  */
 bool addPlayer(players_t players, int *nbPlayer);
 
 /**
  * @brief Sends all cards in hand to the player
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player to send cards to
  */
 void giveCard(players_t players, int player);
 
 /**
  * @brief Confirms to the player that their card is valid
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player to notify
  */
 void okCard(players_t players, int player);
 
 /**
  * @brief Sends the current trick to all players for display
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] pli Current trick (4 cards)
  */
 void givePli(players_t players, pli_t pli);
 
 /**
  * @brief Asks a player if they want to take the revealed trump card (first round)
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player being asked
  * @return true if player accepts, false otherwise
  */
@@ -152,7 +244,7 @@ bool askTakeAtout(players_t players, int player);
 
 /**
  * @brief Asks a player if they want to choose trump (second round) and which suit
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player being asked
  * @param[out] c Chosen trump suit (if player accepts)
  * @return true if player accepts and chooses a suit, false otherwise
@@ -161,11 +253,37 @@ bool askTakeAtoutTurn2(players_t players, int player, enum colorCard *c);
 
 /**
  * @brief Asks a player which card they want to play
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player being asked
+ * @param[in] legal Set of cards the player is allowed to play (see legalMoves)
  * @return The card chosen by the player
  */
-enum card askCard(players_t players, int player);
+enum card askCard(players_t players, int player, cardSet_t legal);
+
+// -------------------- Random Functions --------------------------------------
+
+/**
+ * @brief Seeds a generator
+ * @param[out] rng Generator to seed
+ * @param[in] seed Initial state
+ * @param[in] stream Sequence selector: same seed, different streams give independent sequences
+ */
+void rngSeed(rng_t *rng, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Draws the next 32-bit number
+ * @param[in,out] rng Generator
+ * @return Uniform number in [0, 2^32[
+ */
+uint32_t rngNext(rng_t *rng);
+
+/**
+ * @brief Draws a number below a bound without modulo bias
+ * @param[in,out] rng Generator
+ * @param[in] bound Exclusive upper bound (> 0)
+ * @return Uniform number in [0, bound[
+ */
+uint32_t rngBounded(rng_t *rng, uint32_t bound);
 
 // -------------------- Variable/Value Functions ------------------------------
 
@@ -188,7 +306,7 @@ int getValueAtoutCard(enum card card);
  * @param[in] card Card to get the name of
  * @return String representation of the card
  */
-char* getNameCard(enum card card);
+const char* getNameCard(enum card card);
 
 // -------------------- Card Management Functions -----------------------------
 
@@ -201,12 +319,9 @@ enum card dealCard(pileCard_t* pileDeck);
 
 /**
  * @brief Resets all cards to initial state for a new round
- * @param[out] pileDeck Deck to reset
- * @param[out] pileEq1 Team 1's won cards pile to reset
- * @param[out] pileEq2 Team 2's won cards pile to reset
- * @param[out] players Array of players whose hands will be cleared
+ * @param[in,out] t Table whose deck, team piles, trick and hands are reset
  */
-void resetCards(pileCard_t* pileDeck, pileCard_t* pileEq1, pileCard_t* pileEq2, players_t players);
+void resetCards(table_t *t);
 
 /**
  * @brief Converts a card name string to its enum value
@@ -224,13 +339,14 @@ int string_to_card(const char *s, enum card *out);
  * @param[in] c Trump suit
  * @return Total points earned by the specified team
  */
-int point_of_gain(pileCard_t* pileEq1, pileCard_t* pileEq2, enum equipe eq, enum colorCard c);
+int point_of_gain(cardSet_t pileEq1, cardSet_t pileEq2, enum equipe eq, enum colorCard c);
 
 /**
  * @brief Shuffles the deck randomly
  * @param[in,out] pileDeck Deck to shuffle
+ * @param[in,out] rng Generator to draw from
  */
-void cardShuffle(pileCard_t* pileDeck);
+void cardShuffle(pileCard_t* pileDeck, rng_t *rng);
 
 /**
  * @brief Verifies if a character represents a valid card suit
@@ -254,9 +370,35 @@ int betterInPli(pli_t pli, enum colorCard c);
  */
 enum colorCard card2Color(enum card card);
 
+/**
+ * @brief Finds the highest ranked card of a suit in a set of cards
+ * @param[in] set Set of cards to search
+ * @param[in] color Suit to search for
+ * @param[in] colorAtout Trump suit (selects the trump ranking when color is trump)
+ * @return The highest card of the specified suit, or NOTHING if none found
+ * @note Constant time: the suit byte is mapped to rank order and bit-scanned
+ */
+enum card highestCardInSet(cardSet_t set, enum colorCard color, enum colorCard colorAtout);
+
+/**
+ * @brief Finds the lowest ranked card of a suit in a set of cards
+ * @param[in] set Set of cards to search
+ * @param[in] color Suit to search for
+ * @param[in] colorAtout Trump suit (selects the trump ranking when color is trump)
+ * @return The lowest card of the specified suit, or NOTHING if none found
+ */
+enum card lowestCardInSet(cardSet_t set, enum colorCard color, enum colorCard colorAtout);
+
+/**
+ * @brief Builds the set of cards already played in a trick
+ * @param[in] pli Current trick
+ * @return Set of the cards in the trick
+ */
+cardSet_t pliToSet(pli_t pli);
+
 /**
  * @brief Finds the highest value card of a specific suit in a player's hand
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player
  * @param[in] color Suit to search for
  * @param[in] colorAtout Trump suit (affects value calculation)
@@ -264,15 +406,30 @@ enum colorCard card2Color(enum card card);
  */
 enum card searchMaxCardInHand(players_t players, int player, enum colorCard color, enum colorCard colorAtout);
 
+/**
+ * @brief Computes every card a player may legally play on the current trick
+ * @param[in] hand Cards in the player's hand
+ * @param[in] pli Current trick (cards in play order, NOTHING for empty slots)
+ * @param[in] trump Trump suit
+ * @param[in] seat Position of the player in the trick (0 = leads, 3 = plays last)
+ * @return Set of playable cards (a subset of hand, never empty if hand is not)
+ * @details Implements Belote rules:
+ *          - Must follow suit if possible, overtrumping when trump is led
+ *          - Partner winning allows any card
+ *          - Otherwise must trump if can't follow suit, overtrumping if possible
+ */
+cardSet_t legalMoves(cardSet_t hand, pli_t pli, enum colorCard trump, int seat);
+
 /**
  * @brief Validates if a card can be legally played according to Belote rules
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] pli Current trick
  * @param[in] player Index of player attempting to play
  * @param[in] colorAtout Trump suit
  * @param[in,out] colorPli Suit led in the trick (updated if first card)
  * @param[in] card Card the player wants to play
  * @return true if card is legal, false otherwise
+ * @note Single lookup in legalMoves()
  */
 bool verifCard(players_t players, pli_t pli, int player, enum colorCard colorAtout, enum colorCard *colorPli, enum card card);
 
@@ -298,102 +455,85 @@ bool isOvercut(enum card maxPlayerCard, enum card maxPliCard, enum colorCard col
 // -------------------- Game Flow Functions -----------------------------------
 
 /**
- * @brief Initializes a card pile by allocating memory
- * @param[out] pile Pointer to pile pointer to initialize
+ * @brief Initializes a table for a new game
+ * @param[out] t Table to initialize
+ * @param[in] seed Seed of the table's random generator
  */
-void initPile(pileCard_t **pile);
+void tableInit(table_t *t, uint64_t seed);
 
 /**
  * @brief Performs the first deal (3 cards to each player)
- * @param[in,out] deck Deck to deal from
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[in] pli Current trick (for display)
+ * @param[in,out] t Table to deal on
  */
-void firstDeal(pileCard_t* deck, players_t players, int *startPlayer, pli_t pli);
+void firstDeal(table_t *t);
 
 /**
- * @brief Conducts the trump selection phase
- * @param[in] players Array of player pointers
- * @param[in] turn Round of bidding (1 or 2)
- * @param[in] startPlayer Pointer to the starting player index
- * @param[out] c Chosen trump suit (only set in round 2)
- * @return Index of player who accepted trump, or -1 if all passed
+ * @brief Performs the second deal (2 cards to each player + reveal trump card)
+ * @param[in,out] t Table to deal on
  */
-int playerTurnAtout(players_t players, int turn, int *startPlayer, enum colorCard *c);
+void secondDeal(table_t *t);
 
 /**
- * @brief Performs the second deal (2 cards to each player + reveal trump card)
- * @param[in,out] deck Deck to deal from
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[out] pli Current trick (stores revealed trump card)
+ * @brief Performs the third deal (3 cards to each player, trump taker gets revealed card)
+ * @param[in,out] t Table to deal on (t->taker must be set)
  */
-void secondDeal(pileCard_t* deck, players_t players, int *startPlayer, pli_t pli);
+void thirdDeal(table_t *t);
 
 /**
- * @brief Performs the third deal (3 cards to each player, trump taker gets revealed card)
- * @param[in,out] deck Deck to deal from
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[in,out] pli Current trick (trump card will be taken)
- * @param[in] playerTakeAtout Index of player who accepted trump
+ * @brief Starts a new round: shuffles, deals 5 cards to each player and reveals a card
+ * @param[in,out] t Table in PHASE_DEAL
+ * @note The table moves to PHASE_BID1, the dealer speaks first. The seed of the
+ *       shuffle is drawn from the table's generator and kept in t->dealSeed
  */
-void thirdDeal(pileCard_t* deck, players_t players, int *startPlayer, pli_t pli, int playerTakeAtout);
+void tableDeal(table_t *t);
 
 /**
- * @brief Manages the complete dealing phase including trump selection
- * @param[in,out] deck Deck to deal from
- * @param[out] pileEq1 Team 1's won cards pile (cleared)
- * @param[out] pileEq2 Team 2's won cards pile (cleared)
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[out] pli Current trick
- * @param[out] c Trump suit determined
- * @return true if trump was selected, false if all players passed
+ * @brief Starts a new round from a given shuffle seed
+ * @param[in,out] t Table in PHASE_DEAL
+ * @param[in] seed Seed of the shuffle, as recorded in dealSeed
+ * @note With the same dealer, the same seed gives the same cards to the same players
  */
-bool turnDeal(pileCard_t *deck, pileCard_t* pileEq1, pileCard_t* pileEq2, players_t players, int *startPlayer, pli_t pli, enum colorCard *c);
+void tableDealSeed(table_t *t, uint64_t seed);
 
 /**
- * @brief Calculates the next player in turn order
- * @param[in] startPlayer Pointer to the starting player index
- * @param[in] nbNextPlayer Number of positions to advance
- * @return Index of the next player (0-3)
+ * @brief Applies a bid of the player to act
+ * @param[in,out] t Table in PHASE_BID1 or PHASE_BID2
+ * @param[in] player Player bidding
+ * @param[in] take true if the player takes
+ * @param[in] color Trump suit chosen (second round only)
+ * @return false if the bid is refused (wrong phase, not the player's turn, invalid suit)
  */
-int nextPlayingPlayer(int *startPlayer, int nbNextPlayer);
+bool tableBid(table_t *t, int player, bool take, enum colorCard color);
 
 /**
- * @brief Manages one complete trick of play
- * @param[in,out] deck Game deck (unused in this function)
- * @param[in,out] pileEq1 Team 1's won cards pile
- * @param[in,out] pileEq2 Team 2's won cards pile
- * @param[in,out] players Array of players
- * @param[in,out] startPlayer Pointer to starting player (updated to winner)
- * @param[in,out] pli Current trick
- * @param[in] c Trump suit
+ * @brief Set of cards the player to act may play
+ * @param[in] t Table in PHASE_PLAY
+ * @return Legal cards of t->toAct
  */
-void turnNormal(pileCard_t *deck, pileCard_t* pileEq1, pileCard_t* pileEq2, players_t players, int *startPlayer, pli_t pli, enum colorCard *c);
+cardSet_t tableLegal(table_t *t);
 
 /**
- * @brief Manages one complete round (manche) of Belote
- * @param[in,out] deck Game deck
- * @param[in,out] pileEq1 Team 1's won cards pile
- * @param[in,out] pileEq2 Team 2's won cards pile
- * @param[in,out] players Array of players
- * @param[in,out] startPlayer Pointer to starting player
- * @param[in,out] pli Current trick
- * @param[out] c Trump suit
- * @param[in,out] scoreEq1 Team 1's score (updated)
- * @param[in,out] scoreEq2 Team 2's score (updated)
- * @return true if round completed successfully, false if all players passed on trump
+ * @brief Plays a card for the player to act, closing the trick and the round when complete
+ * @param[in,out] t Table in PHASE_PLAY
+ * @param[in] player Player playing
+ * @param[in] card Card played
+ * @return false if the move is refused (wrong phase, not the player's turn, illegal card)
  */
-bool manche(pileCard_t *deck, pileCard_t* pileEq1, pileCard_t* pileEq2, players_t players, int *startPlayer, pli_t pli, enum colorCard *c, int *scoreEq1, int *scoreEq2);
+bool tablePlay(table_t *t, int player, enum card card);
+
+/**
+ * @brief Calculates the next player in turn order
+ * @param[in] startPlayer Pointer to the starting player index
+ * @param[in] nbNextPlayer Number of positions to advance
+ * @return Index of the next player (0-3)
+ */
+int nextPlayingPlayer(int *startPlayer, int nbNextPlayer);
 
 /**
- * @brief Main game loop managing complete Belote game until a team wins
- * @param[in] players Array of 4 players
+ * @brief Main game loop driving a table with the interactive players until a team wins
+ * @param[in,out] t Table holding the 4 players
  */
-void game(players_t players);
+void game(table_t *t);
 
 // -------------------- Display Functions -------------------------------------
 
@@ -409,13 +549,13 @@ void str_color(enum card card);
  * @param[in] pileEq1 Team 1's won cards
  * @param[in] pileEq2 Team 2's won cards
  */
-void afficherGainEq(pileCard_t* pileDeck, pileCard_t* pileEq1, pileCard_t* pileEq2);
+void afficherGainEq(pileCard_t* pileDeck, cardSet_t pileEq1, cardSet_t pileEq2);
 
 /**
  * @brief Displays all cards in a team's won pile
  * @param[in] pileEq Team's card pile to display
  */
-void afficherEq(pileCard_t* pileEq);
+void afficherEq(cardSet_t pileEq);
 
 /**
  * @brief Displays remaining cards in the deck
@@ -0,0 +1,117 @@
+/**
+ *	\file		parties.h
+ *	\brief		Spécification de la table des parties en attente de joueurs
+ *	\author		Samir El Khattabi
+ *	\date		16 février 2026
+ *	\version	1.0
+ */
+
+#ifndef PARTIES_H
+#define PARTIES_H
+
+#include <stdint.h>
+#include "users.h"
+
+
+/**
+ *	\def		NB_PLACES
+ *	\brief		Nombre de joueurs d'une partie
+ */
+#define NB_PLACES	4
+
+/**
+ *	\def		MAX_PARTIES
+ *	\brief		Nombre maximal de parties simultanées
+ */
+#define MAX_PARTIES	(MAX_USERS / NB_PLACES)
+
+
+
+/*
+ * S T R U C T U R E S   DE   D O N N E E S
+ */
+
+/**
+ *	\struct		partie_t
+ *	\brief		Partie : ses joueurs et son chaînage dans la liste de son nombre de places libres
+ */
+typedef struct {
+	int joueurs[NB_PLACES];	/**< Indices des joueurs, joueurs[0] est l'hôte */
+	int nbJoueurs;			/**< Nombre de joueurs (0 : emplacement libre) */
+	uint32_t generation;	/**< Génération de l'emplacement, incrémentée à sa libération */
+	int prec;				/**< Partie précédente de la même liste, -1 si aucune */
+	int suiv;				/**< Partie suivante de la même liste (ou emplacement libre suivant) */
+} partie_t;
+
+/**
+ *	\struct		parties_t
+ *	\brief		Table des parties
+ *	\note		Les parties incomplètes sont rangées dans une liste par nombre de places libres ;
+ *				le bit k de nonVides indique que la liste k n'est pas vide. La partie la plus
+ *				proche d'être complète est donc en tête de la liste du bit de poids faible.
+ *				Les emplacements sont réservés une fois pour toutes (zone non initialisée du
+ *				programme) : créer, remplir et supprimer une partie n'alloue rien
+ */
+typedef struct {
+	partie_t parties[MAX_PARTIES];	/**< Parties */
+	int nbParties;					/**< Nombre d'emplacements utilisés (libres compris) */
+	int premierLibre;				/**< Premier emplacement libre, -1 si aucun */
+	int listes[NB_PLACES + 1];		/**< Première partie de chaque nombre de places libres, -1 si aucune */
+	uint32_t nonVides;				/**< Listes non vides (bit k : liste k) */
+	pthread_mutex_t verrou;			/**< Protège la table */
+} parties_t;
+
+/*
+ * P R O T O T Y P E S   DES   F O N C T I O N S
+ */
+
+/**
+ *	\fn			hPartie_t creerPartie(int indUser)
+ *	\brief		Crée une partie dont l'utilisateur est l'hôte (il quitte sa partie précédente)
+ *	\param 		indUser : Index de l'utilisateur
+ *	\return		La poignée de la partie, PARTIE_NULLE si la table des parties est pleine
+ */
+hPartie_t creerPartie(int indUser);
+
+/**
+ *	\fn			int rejoindrePartie(int indUser, hPartie_t partie)
+ *	\brief		Ajoute l'utilisateur à une partie (il quitte sa partie précédente)
+ *	\param 		indUser : Index de l'utilisateur
+ *	\param 		partie : Poignée de la partie
+ *	\return		0, ou -1 si la poignée est périmée ou si la partie est complète
+ */
+int rejoindrePartie(int indUser, hPartie_t partie);
+
+/**
+ *	\fn			hPartie_t rejoindrePartieAlea(int indUser)
+ *	\brief		Ajoute l'utilisateur à la partie incomplète la plus proche d'être complète
+ *	\param 		indUser : Index de l'utilisateur
+ *	\return		La poignée de la partie, PARTIE_NULLE si aucune partie n'attend de joueur
+ *	\note		Temps constant : tête de la première liste non vide
+ */
+hPartie_t rejoindrePartieAlea(int indUser);
+
+/**
+ *	\fn			void quitterPartie(int indUser)
+ *	\brief		Retire l'utilisateur de sa partie, la partie est supprimée quand elle est vide
+ *	\param 		indUser : Index de l'utilisateur
+ */
+void quitterPartie(int indUser);
+
+/**
+ *	\fn			int hotePartie(hPartie_t partie)
+ *	\brief		Hôte d'une partie
+ *	\param 		partie : Poignée de la partie
+ *	\return		L'index de l'utilisateur hôte, ou -1 si la poignée est périmée
+ */
+int hotePartie(hPartie_t partie);
+
+/**
+ *	\fn			int isFull(hPartie_t partie)
+ *	\brief		Indique si une partie est complète
+ *	\param 		partie : Poignée de la partie
+ *	\return		1 si la partie est complète ou si la poignée est périmée, 0 sinon
+ */
+int isFull(hPartie_t partie);
+
+#endif /* PARTIES_H */
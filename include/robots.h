@@ -0,0 +1,55 @@
+/**
+ * @file robots.h
+ * @brief Automatic players for the Belote engine
+ * @details A robot is a policy_t: one callback per decision of the table's state machine.
+ *          Robots only read the table and answer, the caller applies the answer with
+ *          tableBid()/tablePlay(), so the same robots drive the simulator and server bots.
+ * @author Raphael ALLO
+ * @date 14/02/2026
+ */
+
+#ifndef ROBOTS_H
+#define ROBOTS_H
+
+#include "moteur.h"
+
+// ==================== STRUCTURES ============================================
+
+/**
+ * @struct policy
+ * @brief Decisions of an automatic player
+ * @note rng is the generator of the calling thread, robots must not use any other state
+ */
+typedef struct policy {
+    const char *name;                                                           ///< Name used to select the robot
+    bool (*bid1)(table_t *t, int player, rng_t *rng);                          ///< First round: take the revealed suit ?
+    bool (*bid2)(table_t *t, int player, enum colorCard *c, rng_t *rng);       ///< Second round: take, and which suit ?
+    enum card (*play)(table_t *t, int player, cardSet_t legal, rng_t *rng);    ///< Card to play among legal
+} policy_t;
+
+// ==================== FUNCTION PROTOTYPES ===================================
+
+/**
+ * @brief Finds a robot by name
+ * @param[in] name Name of the robot ("hasard", "glouton", "passif")
+ * @return The robot, or NULL if no robot has this name
+ */
+const policy_t *findPolicy(const char *name);
+
+/**
+ * @brief Lists the available robots
+ * @param[out] nb Number of robots
+ * @return Array of the robots
+ */
+const policy_t *listPolicies(int *nb);
+
+/**
+ * @brief Asks a robot for the decision expected by the table and applies it
+ * @param[in,out] t Table in PHASE_BID1, PHASE_BID2 or PHASE_PLAY
+ * @param[in] policy Robot of the player to act
+ * @param[in,out] rng Generator of the calling thread
+ * @return false if the robot's answer was refused by the table
+ */
+bool policyStep(table_t *t, const policy_t *policy, rng_t *rng);
+
+#endif // ROBOTS_H
@@ -41,6 +41,14 @@ struct socket {
 	int mode;						/**< mode connecté/non : STREAM/DGRAM	*/
 	struct sockaddr_in addrLoc;		/**< adresse locale de la socket 		*/
 	struct sockaddr_in addrDst;		/**< adresse distante de la socket 		*/
+	int trame;						/**< délimitation des messages STREAM	*/
+	struct rxTrame *rx;				/**< tampon de réassemblage (ou NULL)	*/
+	int codec;						/**< codec négocié des requêtes/réponses*/
+	int morte;						/**< erreur d'émission/réception : la
+										 connexion est à fermer par son
+										 propriétaire (cf. envoyerSts())	*/
+	struct fileEmission *tx;		/**< file d'émission non bloquante (ou
+										 NULL : envoi bloquant)				*/
 };
 /**
  *	\typedef	socket_t
@@ -102,6 +110,33 @@ socket_t accepterClt (const socket_t sockEcoute);
  *	\result		socket connectée au serveur fourni en paramètre
  */
 socket_t connecterClt2Srv (char *adrIP, short port);
+/**
+ *	\fn			int accepterCltSts (const socket_t sockEcoute, socket_t *sock)
+ *	\brief		Acceptation d'une demande de connexion sans arrêt du processus en cas d'erreur
+ *	\param		sockEcoute : socket d'écoute pour réception de la demande
+ *	\param		sock : socket de dialogue connectée avec le client
+ *	\result		0, -1 en cas d'erreur (errno positionné, sock non modifiée)
+ */
+int accepterCltSts (const socket_t sockEcoute, socket_t *sock);
+/**
+ *	\fn			int connecterClt2SrvSts (char *adrIP, short port, socket_t *sock)
+ *	\brief		Connexion au serveur sans arrêt du processus en cas d'erreur
+ *	\param		adrIP : adresse IP du serveur à connecter
+ *	\param		port : port TCP du serveur à connecter
+ *	\param		sock : socket connectée au serveur
+ *	\result		0, -1 en cas d'erreur (errno positionné, sock non modifiée)
+ */
+int connecterClt2SrvSts (char *adrIP, short port, socket_t *sock);
+/**
+ *	\fn			int delaiReception (socket_t *sock, int delaiMs)
+ *	\brief		Borne l'attente d'une réception bloquante sur une socket
+ *	\param		sock : socket d'échange
+ *	\param		delaiMs : attente maximale, 0 pour attendre indéfiniment
+ *	\note		Une réception qui dépasse le délai échoue (EAGAIN) : recevoirSts() rend -1
+ *				et marque la socket morte au lieu de bloquer le thread pour toujours
+ *	\result		0, -1 en cas d'erreur (errno positionné)
+ */
+int delaiReception (socket_t *sock, int delaiMs);
 
 
 
@@ -1,4 +1,5 @@
 #include "libRepReq.h"
+#include "boucleEvt.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
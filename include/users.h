@@ -9,14 +9,34 @@
 #ifndef USERS_H
 #define USERS_H
 
+#include <stdint.h>
+#include <pthread.h>
 #include "session.h"
 
 
+/**
+ *	\def		TAILLE_BLOC_USERS
+ *	\brief		Nombre d'utilisateurs par bloc alloué (la table grandit bloc par bloc)
+ */
+#define TAILLE_BLOC_USERS	1024
+
+/**
+ *	\def		MAX_BLOCS_USERS
+ *	\brief		Nombre maximal de blocs d'utilisateurs
+ */
+#define MAX_BLOCS_USERS		1024
+
 /**
  *	\def		MAX_USERS
  *	\brief		Nombre maximal de joueurs/utilisateurs autorisés
  */
-#define MAX_USERS	16
+#define MAX_USERS	(TAILLE_BLOC_USERS * MAX_BLOCS_USERS)
+
+/**
+ *	\def		NB_SHARDS_USERS
+ *	\brief		Nombre de partitions de chaque index (puissance de 2), verrouillées séparément
+ */
+#define NB_SHARDS_USERS	16
 
 /**
  *	\def		MAX_NAME
@@ -24,6 +44,25 @@
  */
 #define MAX_NAME    64
 
+/**
+ *	\def		FICHIER_USERS, JOURNAL_USERS
+ *	\brief		Instantané de la base (enregistrements de taille fixe) et journal des modifications
+ */
+#define FICHIER_USERS	"users.dat"
+#define JOURNAL_USERS	"users.log"
+
+/**
+ *	\def		DELAI_JOURNAL_MS
+ *	\brief		Délai de regroupement des écritures du journal avant un fdatasync commun
+ */
+#define DELAI_JOURNAL_MS	10
+
+/**
+ *	\def		MAX_JOURNAL_USERS
+ *	\brief		Nombre d'enregistrements du journal au-delà duquel il est compacté dans l'instantané
+ */
+#define MAX_JOURNAL_USERS	65536
+
 
 
 /*
@@ -38,36 +77,76 @@ typedef char name_t[MAX_NAME];
 
 struct user_s;
 
-typedef struct user_s user_t;
-
-
 /**
- *	\struct		party_t
- *	\brief		Structure globale de gestion d'une party
+ *	\struct		hPartie_t
+ *	\brief		Poignée d'une partie (voir parties.h) : emplacement et génération de l'emplacement
+ *	\note		La génération change à chaque libération : une poignée conservée après la fin
+ *				de la partie est refusée, même si l'emplacement a été réutilisé
  */
 typedef struct {
-	user_t *list[4];	/**< Tableau des utilisateurs */
-	int nbJoueurs;			/**< Nombre actuel d'utilisateurs enregistrés */
-} party_t;
+	int32_t index;			/**< Emplacement de la partie, -1 pour aucune partie */
+	uint32_t generation;	/**< Génération de l'emplacement */
+} hPartie_t;
+
+/**
+ *	\def		PARTIE_NULLE
+ *	\brief		Poignée ne désignant aucune partie
+ */
+#define PARTIE_NULLE	((hPartie_t){-1, 0})
+
+typedef struct user_s user_t;
+
 
 /**
  *	\struct		user_t
  *	\brief		Représente un utilisateur connecté ou enregistré
  */
 struct user_s {
-	name_t name; 		/**< Nom de l'utilisateur */
+	name_t name; 		/**< Nom de l'utilisateur ("" : emplacement libre) */
 	socket_t *sDial;	/**< Pointeur vers la socket de dialogue active */
 	int indDest;		/**< Index de l'interlocuteur (ligne destinataire) */
-	party_t party;
+	int suivantLibre;	/**< Emplacement libre suivant (liste des emplacements libres) */
+	hPartie_t partie;	/**< Sa partie (PARTIE_NULLE si aucune) */
 } ;
 
+/**
+ *	\struct		tableIndex_s
+ *	\brief		Table à adressage ouvert (sondage linéaire) vers les indices des utilisateurs
+ *	\note		Une case vaut l'indice de l'utilisateur + 1, 0 pour une case vide.
+ *				Une table remplacée par une plus grande n'est jamais libérée (un lecteur
+ *				peut encore la parcourir) : la mémoire perdue reste inférieure à la table active
+ */
+typedef struct tableIndex_s {
+	unsigned int capacite;	/**< Nombre de cases (puissance de 2) */
+	unsigned int nb;		/**< Nombre de cases occupées */
+	int cases[];			/**< Cases de l'index */
+} tableIndex_t;
+
+/**
+ *	\struct		shardUsers_t
+ *	\brief		Partition d'un index : les écrivains s'excluent par un mutex, les lecteurs
+ *				ne prennent aucun verrou et recommencent si la version a changé (seqlock)
+ */
+typedef struct {
+	pthread_mutex_t verrou;		/**< Exclusion des écrivains de la partition */
+	unsigned int version;		/**< Impaire pendant une écriture */
+	tableIndex_t *table;		/**< Table courante */
+} __attribute__((aligned(64))) shardUsers_t;
+
 /**
  *	\struct		users_t
  *	\brief		Structure globale de gestion des utilisateurs
+ *	\note		Les utilisateurs sont rangés dans des blocs alloués à la demande et jamais
+ *				déplacés : indices et adresses restent stables quand la table grandit
  */
 typedef struct {
-	user_t tab[MAX_USERS];	/**< Tableau des utilisateurs */
-	int nbUsers;			/**< Nombre actuel d'utilisateurs enregistrés */
+	user_t *blocs[MAX_BLOCS_USERS];	/**< Blocs de TAILLE_BLOC_USERS utilisateurs */
+	int nbBlocs;			/**< Nombre de blocs alloués */
+	int nbUsers;			/**< Nombre d'emplacements utilisés (libres compris) */
+	int premierLibre;		/**< Premier emplacement libre, -1 si aucun */
+	pthread_mutex_t verrou;	/**< Protège l'allocation des emplacements (blocs, liste libre) */
+	shardUsers_t parNom[NB_SHARDS_USERS];		/**< Index par nom */
+	shardUsers_t parSocket[NB_SHARDS_USERS];	/**< Index par socket de dialogue */
 } users_t;
 
 /*
@@ -82,11 +161,19 @@ typedef struct {
  */
 int afficherUsers(char *cde); 
 
+/**
+ *	\fn			int nbUsers(void)
+ *	\brief		Borne des indices d'utilisateurs (les emplacements libres ont un nom vide)
+ *	\return		Nombre d'emplacements utilisés
+ */
+int nbUsers(void);
+
 /**
  *	\fn			int trouverUser(name_t nom)
  *	\brief		Recherche un utilisateur par son nom
  *	\param 		nom : Le nom de l'utilisateur recherché
  *	\return		L'index de l'utilisateur dans le tableau, ou -1 s'il n'existe pas
+ *	\note		Temps constant (index par nom), sans verrou : n'attend jamais un écrivain
  */
 int trouverUser(name_t nom);
 
@@ -96,9 +183,35 @@ int trouverUser(name_t nom);
  *	\param 		nom : Nom du nouvel utilisateur
  *	\param 		sDial : Pointeur vers sa socket de dialogue
  *	\return		L'index du nouvel utilisateur, ou -1 si la table est pleine
+ *	\note		Réutilise en priorité un emplacement libéré par supprimerUser()
  */
 int creerUser(name_t nom, socket_t *sDial);
 
+/**
+ *	\fn			void supprimerUser(int indUser)
+ *	\brief		Retire un utilisateur de la table, son emplacement est réutilisable
+ *	\param 		indUser : Index de l'utilisateur
+ */
+void supprimerUser(int indUser);
+
+/**
+ *	\fn			int userSocket(socket_t *sDial)
+ *	\brief		Recherche l'utilisateur associé à une socket de dialogue
+ *	\param 		sDial : Socket de dialogue
+ *	\return		L'index de l'utilisateur, ou -1 si la socket n'est pas identifiée
+ */
+int userSocket(socket_t *sDial);
+
+/**
+ *	\fn			int enregistrerUser(name_t nom, socket_t *sDial)
+ *	\brief		Associe une socket à un utilisateur existant, ou le crée s'il est inconnu
+ *	\param 		nom : Nom de l'utilisateur
+ *	\param 		sDial : Pointeur vers sa socket de dialogue
+ *	\return		L'index de l'utilisateur, ou -1 si la table est pleine ou si l'utilisateur
+ *				est déjà connecté sur une autre socket (jusqu'à son deconnecterUser())
+ */
+int enregistrerUser(name_t nom, socket_t *sDial);
+
 /**
  *	\fn			int identifierUser(socket_t *sDial)
  *	\brief		Gère la phase d'identification (lecture de la requête ID)
@@ -130,6 +243,22 @@ void modifierDest(int indUser, name_t destName);
  */
 int indiceDest(int indUser);
 
+/**
+ *	\fn			hPartie_t partieUser(int indUser)
+ *	\brief		Récupère la partie d'un utilisateur
+ *	\param 		indUser : Index de l'utilisateur
+ *	\return		Poignée de la partie (PARTIE_NULLE si aucune ou si index invalide)
+ */
+hPartie_t partieUser(int indUser);
+
+/**
+ *	\fn			void modifierPartie(int indUser, hPartie_t partie)
+ *	\brief		Définit la partie d'un utilisateur (réservé à la table des parties)
+ *	\param 		indUser : Index de l'utilisateur
+ *	\param 		partie : Poignée de la partie (PARTIE_NULLE si aucune)
+ */
+void modifierPartie(int indUser, hPartie_t partie);
+
 /**
  *	\fn			char * nameUser(int indUser)
  *	\brief		Récupère le nom d'un utilisateur par son index
@@ -148,17 +277,26 @@ socket_t *socketUser(int indUser);
 
 /**
  *	\fn			void lireUsers(void)
- *	\brief		Charge la base des utilisateurs depuis le fichier "users.dat"
+ *	\brief		Charge la base des utilisateurs puis active la journalisation
+ *	\note		L'instantané FICHIER_USERS est projeté en mémoire (mmap), seul le journal
+ *				JOURNAL_USERS est rejoué ; un enregistrement incomplet en fin de journal est
+ *				ignoré. Ensuite, chaque création/suppression est ajoutée au journal par un
+ *				thread qui regroupe les écritures (un fdatasync par lot) et compacte le journal
  */
 void lireUsers(void);
 
+/**
+ *	\fn			void synchroniserUsers(void)
+ *	\brief		Attend que toutes les modifications déjà faites soient écrites sur disque
+ */
+void synchroniserUsers(void);
+
 /**
  *	\fn			void ecrireUsers(void)
- *	\brief		Sauvegarde la base actuelle des utilisateurs dans le fichier "users.dat"
+ *	\brief		Compacte la base : réécrit l'instantané FICHIER_USERS et vide le journal
+ *	\note		Inutile pour la persistance (le journal suffit), réduit le temps de démarrage
  */
 void ecrireUsers(void);
 
-void creerPartie(socket_t * sDial);
-int isFull(int idUser);
 
 #endif /* USERS_H */
\ No newline at end of file
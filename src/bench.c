@@ -0,0 +1,361 @@
+/**
+ *	\file		bench.c
+ *	\brief		Micro-benchmarks des chemins critiques du moteur et du protocole
+ *	\author		Alexandre BREVIERE
+ *	\date		15 février 2026
+ *	\version	1.0
+ *
+ *	Usage : bench [-c baseline] [filtre]
+ *	Chaque benchmark est répété NB_REPET fois, le meilleur temps est retenu (ns/op).
+ *	Les allocations (malloc/calloc/realloc) sont comptées par l'éditeur de liens
+ *	(-Wl,--wrap) sur tout le code de l'application, hors libc.
+ *	Les données sont générées avec une graine fixe : deux exécutions mesurent le même travail.
+ */
+#include <sys/socket.h>
+#include "../include/libRepReq.h"
+#include "../include/moteur.h"
+
+/*
+*****************************************************************************************
+ *	\noop		D E F I N I T I O N   DES   C O N S T A N T E S
+ */
+/**
+ *	\def		NB_REPET
+ *	\brief		Nombre de mesures par benchmark (le meilleur temps est retenu)
+ */
+#define NB_REPET	5
+/**
+ *	\def		NS_MESURE
+ *	\brief		Durée minimale d'une mesure (ns), le nombre d'itérations est calibré en conséquence
+ */
+#define NS_MESURE	20000000ULL
+/**
+ *	\def		NB_JEUX
+ *	\brief		Nombre de situations de jeu pré-calculées parcourues par les benchmarks du moteur
+ */
+#define NB_JEUX		256
+/**
+ *	\def		NB_USERS_BENCH
+ *	\brief		Nombre d'utilisateurs enregistrés pour trouverUser (la moitié des noms cherchés existe)
+ */
+#define NB_USERS_BENCH	16
+/*
+*****************************************************************************************
+ *	\noop		S T R C T U R E S   DE   D O N N E E S
+ */
+/**
+ *	\struct		bench_t
+ *	\brief		Benchmark : n exécutions de l'opération mesurée
+ */
+typedef struct {
+	const char *nom;			/**< nom affiché et filtré				*/
+	void (*executer)(long n);	/**< exécute n opérations				*/
+} bench_t;
+/**
+ *	\struct		jeu_t
+ *	\brief		Situation de jeu : main du joueur, pli en cours et atout
+ */
+typedef struct {
+	players_t players;		/**< mains des 4 joueurs					*/
+	pli_t pli;				/**< pli en cours (0 à 3 cartes)			*/
+	int joueur;				/**< joueur dont c'est le tour				*/
+	enum card carte;		/**< carte de sa main qu'il propose			*/
+	enum colorCard atout;	/**< couleur d'atout						*/
+	cardSet_t pile1, pile2;	/**< plis remportés par chaque équipe		*/
+} jeu_t;
+/*
+*****************************************************************************************
+ *	\noop		D E C L A R A T I O N   DES   V A R I A B L E S    G L O B A L E S
+ */
+static long nbAllocs;			/**< allocations comptées par les enveloppes	*/
+static volatile long puits;		/**< résultat des opérations (non éliminées)	*/
+static jeu_t jeux[NB_JEUX];
+static name_t noms[NB_JEUX];
+static socket_t sockA, sockB;	/**< paire de sockets locales (aller-retour)	*/
+/*
+*****************************************************************************************
+ *	\noop		C O M P T A G E   DES   A L L O C A T I O N S
+ */
+void *__real_malloc(size_t taille);
+void *__real_calloc(size_t nb, size_t taille);
+void *__real_realloc(void *ptr, size_t taille);
+void *__wrap_malloc(size_t taille) { nbAllocs++; return __real_malloc(taille); }
+void *__wrap_calloc(size_t nb, size_t taille) { nbAllocs++; return __real_calloc(nb, taille); }
+void *__wrap_realloc(void *ptr, size_t taille) { nbAllocs++; return __real_realloc(ptr, taille); }
+/*
+*****************************************************************************************
+ *	\noop		P R E P A R A T I O N
+ */
+/**
+ *	\fn			static void preparerJeux(void)
+ *	\brief		Tire NB_JEUX situations de jeu : mains de 8 cartes, plis de 0 à 3 cartes
+ */
+static void preparerJeux(void) {
+	rng_t rng;
+	pileCard_t deck;
+
+	rngSeed(&rng, 2026, 0);
+	for (int j = 0; j < NB_JEUX; j++) {
+		jeu_t *jeu = &jeux[j];
+		int nbPli = rngBounded(&rng, PLAYERS_MAX);
+
+		for (int i = 0; i < NB_CARD_DECK; i++) deck.deck[i] = i;
+		deck.lastcard = 0;
+		cardShuffle(&deck, &rng);
+		for (int p = 0; p < PLAYERS_MAX; p++) {
+			jeu->players[p].num = p;
+			jeu->players[p].cards = 0;
+			for (int c = 0; c < NB_CARD_HAND; c++) jeu->players[p].cards |= CARD_BIT(dealCard(&deck));
+		}
+		for (int i = 0; i < PLAYERS_MAX; i++) jeu->pli[i] = NOTHING;
+		for (int i = 0; i < nbPli; i++) jeu->pli[i] = __builtin_ctz(jeu->players[(i + 1) % PLAYERS_MAX].cards);
+		jeu->joueur = (nbPli + 1) % PLAYERS_MAX;
+		cardSet_t main = jeu->players[jeu->joueur].cards;
+		for (int k = rngBounded(&rng, NB_CARD_HAND); k > 0; k--) main &= main - 1;
+		jeu->carte = __builtin_ctz(main);
+		jeu->atout = rngBounded(&rng, 4);
+		jeu->pile1 = jeu->players[0].cards | jeu->players[2].cards;
+		jeu->pile2 = jeu->players[1].cards | jeu->players[3].cards;
+		sprintf(noms[j], "joueur%d", (int)rngBounded(&rng, 2 * NB_USERS_BENCH));
+	}
+}
+/**
+ *	\fn			static void preparerUsers(void)
+ *	\brief		Remplit la table des utilisateurs (sans les traces de creerUser) et
+ *				ouvre trois parties incomplètes (1, 2 et 3 joueurs)
+ */
+static void preparerUsers(void) {
+	name_t nom;
+	int sortie = dup(STDOUT_FILENO);
+
+	fflush(stdout);
+	freopen("/dev/null", "w", stdout);
+	for (int i = 0; i < NB_USERS_BENCH; i++) {
+		sprintf(nom, "joueur%d", i);
+		creerUser(nom, NULL);
+	}
+	creerPartie(0);
+	creerPartie(1);
+	rejoindrePartie(2, partieUser(1));
+	creerPartie(3);
+	rejoindrePartie(4, partieUser(3));
+	rejoindrePartie(5, partieUser(3));
+	fflush(stdout);
+	dup2(sortie, STDOUT_FILENO);
+	close(sortie);
+}
+/**
+ *	\fn			static void preparerSockets(void)
+ *	\brief		Crée la paire de sockets de l'aller-retour envoyer()/recevoir()
+ */
+static void preparerSockets(void) {
+	int fds[2];
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+		perror("--socketpair()--");
+		exit(-1);
+	}
+	memset(&sockA, 0, sizeof(socket_t));
+	memset(&sockB, 0, sizeof(socket_t));
+	sockA.fd = fds[0];
+	sockB.fd = fds[1];
+	sockA.mode = sockB.mode = SOCK_STREAM;
+}
+/*
+*****************************************************************************************
+ *	\noop		B E N C H M A R K S
+ */
+static void benchVerifCard(long n) {
+	enum colorCard colorPli;
+	for (long i = 0; i < n; i++) {
+		jeu_t *jeu = &jeux[i % NB_JEUX];
+		puits += verifCard(jeu->players, jeu->pli, jeu->joueur, jeu->atout, &colorPli, jeu->carte);
+	}
+}
+static void benchBetterInPli(long n) {
+	for (long i = 0; i < n; i++) {
+		jeu_t *jeu = &jeux[i % NB_JEUX];
+		pli_t pli;
+		for (int p = 0; p < PLAYERS_MAX; p++) pli[p] = __builtin_ctz(jeu->players[p].cards);
+		puits += betterInPli(pli, jeu->atout);
+	}
+}
+static void benchSearchMaxCardInHand(long n) {
+	for (long i = 0; i < n; i++) {
+		jeu_t *jeu = &jeux[i % NB_JEUX];
+		puits += searchMaxCardInHand(jeu->players, i % PLAYERS_MAX, i % 4, jeu->atout);
+	}
+}
+static void benchPointOfGain(long n) {
+	for (long i = 0; i < n; i++) {
+		jeu_t *jeu = &jeux[i % NB_JEUX];
+		puits += point_of_gain(jeu->pile1, jeu->pile2, i % 2, jeu->atout);
+	}
+}
+static void benchCardShuffle(long n) {
+	pileCard_t deck;
+	rng_t rng;
+	rngSeed(&rng, 1, 0);
+	for (int i = 0; i < NB_CARD_DECK; i++) deck.deck[i] = i;
+	for (long i = 0; i < n; i++) {
+		cardShuffle(&deck, &rng);
+		puits += deck.deck[0];
+	}
+}
+static void benchStringToCard(long n) {
+	enum card card;
+	for (long i = 0; i < n; i++) {
+		string_to_card(getNameCard(i % NB_CARD_DECK), &card);
+		puits += card;
+	}
+}
+static void benchReq2str(long n) {
+	requete_t req = {301, "LOGIN", "joueur12", OPT_TEXTE};
+	buffer_t buff;
+	for (long i = 0; i < n; i++) {
+		req.idReq = 300 + i % 6;
+		req2str(&req, buff);
+		puits += buff[0];
+	}
+}
+static void benchStr2req(long n) {
+	requete_t req;
+	for (long i = 0; i < n; i++) {
+		str2req("301:LOGIN:joueur12", sizeof("301:LOGIN:joueur12"), &req);
+		puits += req.idReq;
+	}
+}
+static void benchTrouverUser(long n) {
+	for (long i = 0; i < n; i++)
+		puits += trouverUser(noms[i % NB_JEUX]);
+}
+static void benchRejoindrePartieAlea(long n) {
+	for (long i = 0; i < n; i++) {
+		puits += rejoindrePartieAlea(NB_USERS_BENCH - 1).index;
+		quitterPartie(NB_USERS_BENCH - 1);
+	}
+}
+/**
+ *	\fn			static void allerRetour(long n, int trame)
+ *	\brief		n aller-retours requête/réponse sur la paire de sockets
+ */
+static void allerRetour(long n, int trame) {
+	requete_t req = {301, "LOGIN", "joueur12", OPT_TEXTE};
+	reponse_t rep;
+	modeTrame(&sockA, trame);
+	modeTrame(&sockB, trame);
+	for (long i = 0; i < n; i++) {
+		envoyer(&sockA, &req, (pFct)req2str);
+		recevoir(&sockB, &rep, (pFctDeSerial)str2rep);
+		envoyer(&sockB, &rep, (pFct)rep2str);
+		recevoir(&sockA, &req, (pFctDeSerial)str2req);
+		puits += req.idReq;
+	}
+}
+static void benchAllerRetourTexte(long n) { allerRetour(n, TRAME_TEXTE); }
+static void benchAllerRetourTrame(long n) { allerRetour(n, TRAME_LONGUEUR); }
+/**
+ *	\var		benchs
+ *	\brief		Liste des benchmarks (l'ordre est celui de l'affichage)
+ */
+static const bench_t benchs[] = {
+	{"verifCard",				benchVerifCard},
+	{"betterInPli",				benchBetterInPli},
+	{"searchMaxCardInHand",		benchSearchMaxCardInHand},
+	{"point_of_gain",			benchPointOfGain},
+	{"cardShuffle",				benchCardShuffle},
+	{"string_to_card",			benchStringToCard},
+	{"req2str",					benchReq2str},
+	{"str2req",					benchStr2req},
+	{"trouverUser",				benchTrouverUser},
+	{"rejoindrePartieAlea",		benchRejoindrePartieAlea},
+	{"envoyer/recevoir texte",	benchAllerRetourTexte},
+	{"envoyer/recevoir trame",	benchAllerRetourTrame},
+};
+/*
+*****************************************************************************************
+ *	\noop		M E S U R E
+ */
+/**
+ *	\fn			static unsigned long long maintenant(void)
+ *	\brief		Horloge monotone en ns
+ */
+static unsigned long long maintenant(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/**
+ *	\fn			static void mesurer(const bench_t *b, double *nsOp, double *allocsOp)
+ *	\brief		Calibre le nombre d'itérations puis retient la meilleure de NB_REPET mesures
+ */
+static void mesurer(const bench_t *b, double *nsOp, double *allocsOp) {
+	unsigned long long deb, ns;
+	long n = 1, allocs;
+
+	// Calibrage : doubler n jusqu'à une mesure d'au moins NS_MESURE/8
+	do {
+		n *= 2;
+		deb = maintenant();
+		b->executer(n);
+		ns = maintenant() - deb;
+	} while (ns < NS_MESURE / 8);
+	n = n * (NS_MESURE / ns) + 1;
+
+	*nsOp = 1e30;
+	for (int r = 0; r < NB_REPET; r++) {
+		allocs = nbAllocs;
+		deb = maintenant();
+		b->executer(n);
+		ns = maintenant() - deb;
+		if ((double)ns / n < *nsOp) *nsOp = (double)ns / n;
+		*allocsOp = (double)(nbAllocs - allocs) / n;
+	}
+}
+/**
+ *	\fn			static int lireBaseline(const char *fichier, const char *nom, double *ns)
+ *	\brief		Cherche le temps de référence d'un benchmark dans un fichier produit par bench
+ *	\result		1 si trouvé, 0 sinon
+ */
+static int lireBaseline(const char *fichier, const char *nom, double *ns) {
+	char ligne[256];
+	int trouve = 0;
+	FILE *fp;
+
+	if (fichier == NULL || (fp = fopen(fichier, "r")) == NULL) return 0;
+	while (!trouve && fgets(ligne, sizeof(ligne), fp) != NULL)
+		trouve = strncmp(ligne, nom, strlen(nom)) == 0 && ligne[strlen(nom)] == ' '
+			&& sscanf(ligne + 24, "%lf", ns) == 1;
+	fclose(fp);
+	return trouve;
+}
+
+int main(int argc, char *argv[]) {
+	const char *baseline = NULL, *filtre = NULL;
+	double nsOp, allocsOp, nsRef;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "c:")) != -1) {
+		if (opt == 'c') baseline = optarg;
+		else {
+			fprintf(stderr, "Usage : %s [-c baseline] [filtre]\n", argv[0]);
+			exit(-1);
+		}
+	}
+	if (optind < argc) filtre = argv[optind];
+
+	preparerJeux();
+	preparerUsers();
+	preparerSockets();
+
+	printf("%-23s %12s %12s%s\n", "# benchmark", "ns/op", "allocs/op", baseline ? "   vs baseline" : "");
+	for (int i = 0; i < (int)(sizeof(benchs) / sizeof(benchs[0])); i++) {
+		if (filtre != NULL && strstr(benchs[i].nom, filtre) == NULL) continue;
+		mesurer(&benchs[i], &nsOp, &allocsOp);
+		printf("%-23s %12.1f %12.2f", benchs[i].nom, nsOp, allocsOp);
+		if (lireBaseline(baseline, benchs[i].nom, &nsRef)) printf("   %+6.1f%%", 100.0 * (nsOp - nsRef) / nsRef);
+		printf("\n");
+		fflush(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,636 @@
+/**
+ *	\file		boucleEvt.c
+ *	\brief		Implémentation de la boucle d'événements (epoll) multiplexant les sockets de dialogue
+ *	\author		Alexandre BREVIERE
+ *	\date		10 février 2026
+ *	\version	1.0
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include "../include/boucleEvt.h"
+
+/*
+*****************************************************************************************
+ *	\noop		DEFINITION  DES   MACROS
+ */
+/**
+ *	\def		CHECK(sts, msg)
+ *	\brief		Macro-fonction qui vérifie que sts est égal -1 (cas d'erreur : sts==-1)
+ *				En cas d'erreur, il y a affichage du message adéquat et fin d'exécution
+ */
+#define CHECK(sts, msg) if ((sts)==-1) {perror(msg); exit(-1);}
+/**
+ *	\def		CHECK_ZERO(sts, msg)
+ *	\brief		Macro-fonction qui vérifie que sts est égal à 0 (cas d'erreur : sts!=0)
+ *				En cas d'erreur, il y a affichage du message adéquat et fin d'exécution
+ */
+#define CHECK_ZERO(sts, msg) if ((sts)!=0) {fprintf(stderr, "erreur threading: %s\n", msg); exit(-1);}
+/*
+*****************************************************************************************
+ *	\noop		D E F I N I T I O N   DES   C O N S T A N T E S
+ */
+/**
+ *	\def		TAILLE_LECTURE
+ *	\brief		Nombre maximal d'octets lus par appel à read() sur une connexion
+ */
+#define TAILLE_LECTURE	(64*1024)
+/**
+ *	\def		CAPACITE_FILE
+ *	\brief		Capacité initiale de la file de tâches d'un travailleur (elle double si besoin)
+ */
+#define CAPACITE_FILE	256
+/*
+*****************************************************************************************
+ *	\noop		S T R C T U R E S   DE   D O N N E E S
+ */
+/**
+ *	\struct		boucle_t
+ *	\brief		Contexte d'une boucle d'événements (une par thread)
+ */
+typedef struct {
+	int epfd;				/**< instance epoll propre à la boucle				*/
+	socket_t sockEcoute;	/**< socket d'écoute partagée entre les boucles	*/
+	pFctMess traiter;		/**< traitement d'un message complet				*/
+	pFctCnx fermer;			/**< traitement d'une déconnexion					*/
+	roue_t roue;			/**< échéances d'inactivité des connexions			*/
+	pthread_mutex_t verrouRoue;	/**< protège la roue (partagée par les travailleurs du pool)	*/
+	int epfdTx;				/**< connexions inscriptibles (EPOLLOUT), incluse dans epfd	*/
+	pthread_mutex_t verrouTx;	/**< tenu pendant la vidange : une connexion n'est pas
+									 libérée tant que la boucle peut encore la vider	*/
+} boucle_t;
+/**
+ *	\struct		tache_t
+ *	\brief		Tâche d'un travailleur : connexion prête à être lue, ou connexion acceptée
+ *				à inscrire (la socket est alors copiée dans la tâche)
+ */
+typedef struct {
+	connexion_t *cnx;		/**< connexion prête, NULL pour une nouvelle connexion	*/
+	socket_t sock;			/**< socket acceptée, si cnx vaut NULL				*/
+} tache_t;
+/**
+ *	\struct		fileTaches_t
+ *	\brief		File double d'un travailleur : il prend ses tâches du côté des plus récentes,
+ *				les autres travailleurs lui volent les plus anciennes
+ */
+typedef struct {
+	pthread_mutex_t verrou;	/**< protège la file (verrou court, sans appel système)	*/
+	tache_t *taches;		/**< tampon circulaire								*/
+	unsigned int capacite;	/**< taille du tampon (puissance de 2)				*/
+	unsigned int deb;		/**< position de la tâche la plus ancienne			*/
+	unsigned int nb;		/**< nombre de tâches								*/
+} __attribute__((aligned(64))) fileTaches_t;
+/**
+ *	\struct		pool_t
+ *	\brief		Pool de travailleurs : un thread accepte et surveille les connexions au repos,
+ *				les travailleurs lisent et traitent les messages
+ */
+typedef struct {
+	boucle_t b;				/**< instance epoll et traitements					*/
+	int nbTravailleurs;		/**< nombre de travailleurs (et de files)			*/
+	fileTaches_t *files;	/**< une file par travailleur						*/
+	pthread_mutex_t verrouAttente;	/**< protège nbTaches pour l'endormissement	*/
+	pthread_cond_t travail;	/**< signalée quand des tâches sont déposées		*/
+	int nbTaches;			/**< tâches déposées non encore prises				*/
+} pool_t;
+/**
+ *	\struct		travailleur_t
+ *	\brief		Contexte d'un thread travailleur
+ */
+typedef struct {
+	pool_t *pool;			/**< pool du travailleur							*/
+	int num;				/**< numéro du travailleur (et de sa file)			*/
+} travailleur_t;
+/*
+*****************************************************************************************
+ *	\noop		D E C L A R A T I O N   DES   V A R I A B L E S    G L O B A L E S
+ */
+static int delaiSonde = DELAI_SONDE_MS;				/**< cf. reglerInactivite()	*/
+static int delaiInactivite = DELAI_INACTIVITE_MS;	/**< cf. reglerInactivite()	*/
+static pFctCnx sonde = NULL;						/**< cf. reglerInactivite()	*/
+static int seuilLentEmission = SEUIL_LENT_EMISSION;	/**< cf. reglerEmission()	*/
+static int seuilMaxEmission = SEUIL_MAX_EMISSION;	/**< cf. reglerEmission()	*/
+/*
+*****************************************************************************************
+ *	\noop		I M P L E M E N T A T I O N   DES   F O N C T I O N S
+ */
+void reglerInactivite(int delaiSondeMs, int delaiInactiviteMs, pFctCnx sonder) {
+	delaiSonde = delaiSondeMs;
+	delaiInactivite = delaiInactiviteMs;
+	sonde = sonder;
+}
+void reglerEmission(int seuilLent, int seuilMax) {
+	seuilLentEmission = seuilLent;
+	seuilMaxEmission = seuilMax;
+}
+/**
+ *	\fn			static void initEmissionBoucle(boucle_t *b)
+ *	\brief		Crée l'instance epoll des connexions à vider et l'inscrit dans celle de la boucle
+ *	\note		Un événement de la boucle portant b lui-même signale des connexions inscriptibles
+ */
+static void initEmissionBoucle(boucle_t *b) {
+	struct epoll_event ev = {EPOLLIN};
+
+	CHECK(b->epfdTx = epoll_create1(EPOLL_CLOEXEC), "--epoll_create1()--");
+	ev.data.ptr = b;
+	CHECK(epoll_ctl(b->epfd, EPOLL_CTL_ADD, b->epfdTx, &ev), "--epoll_ctl()--");
+	CHECK_ZERO(pthread_mutex_init(&b->verrouTx, NULL), "pthread_mutex_init");
+}
+/**
+ *	\fn			static void inscrireEmission(boucle_t *b, connexion_t *cnx)
+ *	\brief		Passe une nouvelle connexion en émission par file
+ *	\note		EPOLLOUT en mode front : un événement chaque fois que de la place se libère
+ *				après un envoi incomplet, sans réarmement ni appel système par envoi
+ */
+static void inscrireEmission(boucle_t *b, connexion_t *cnx) {
+	struct epoll_event ev = {EPOLLOUT | EPOLLET};
+
+	initFileEmission(&cnx->sock, &cnx->tx, seuilLentEmission, seuilMaxEmission);
+	ev.data.ptr = cnx;
+	CHECK(epoll_ctl(b->epfdTx, EPOLL_CTL_ADD, cnx->sock.fd, &ev), "--epoll_ctl()--");
+}
+/**
+ *	\fn			static void viderCnxs(boucle_t *b)
+ *	\brief		Vide les files d'émission des connexions redevenues inscriptibles
+ *	\note		Un client en erreur est coupé (shutdown()) : sa lecture rend 0 et la boucle
+ *				le ferme par le chemin habituel
+ */
+static void viderCnxs(boucle_t *b) {
+	struct epoll_event evts[MAX_EVTS];
+	connexion_t *cnx;
+	int nbEvts;
+
+	CHECK_ZERO(pthread_mutex_lock(&b->verrouTx), "pthread_mutex_lock");
+	do {
+		while ((nbEvts = epoll_wait(b->epfdTx, evts, MAX_EVTS, 0)) == -1 && errno == EINTR);
+		CHECK(nbEvts, "--epoll_wait()--");
+		for (int i = 0; i < nbEvts; i++) {
+			cnx = (connexion_t *)evts[i].data.ptr;
+			if (viderFileEmission(&cnx->sock) == -1) {
+				cnx->sock.morte = 1;
+				shutdown(cnx->sock.fd, SHUT_RDWR);
+			}
+		}
+	} while (nbEvts == MAX_EVTS);
+	CHECK_ZERO(pthread_mutex_unlock(&b->verrouTx), "pthread_mutex_unlock");
+}
+/**
+ *	\fn			static void initRoueBoucle(boucle_t *b)
+ *	\brief		Initialise la roue des échéances d'inactivité d'une boucle
+ */
+static void initRoueBoucle(boucle_t *b) {
+	initRoue(&b->roue, RESOLUTION_INACTIVITE_MS);
+	CHECK_ZERO(pthread_mutex_init(&b->verrouRoue, NULL), "pthread_mutex_init");
+}
+/**
+ *	\fn			static void expirerCnx(minuteur_t *m, void *arg)
+ *	\brief		Vérification d'inactivité d'une connexion (verrou de la roue pris)
+ *	\note		Une connexion muette est sondée, puis fermée à son échéance par shutdown() :
+ *				la boucle lit alors 0 octet et la ferme par le chemin habituel, le
+ *				traitement fermer (cf. deconnecterUser()) libérant son utilisateur
+ */
+static void expirerCnx(minuteur_t *m, void *arg) {
+	boucle_t *b = (boucle_t *)arg;
+	connexion_t *cnx = (connexion_t *)((char *)m - offsetof(connexion_t, inactivite));
+	uint64_t maintenant = horlogeMs(), activite = __atomic_load_n(&cnx->activite, __ATOMIC_RELAXED), echeance;
+	int enAttente;
+
+	// Connexion en cours de traitement : elle n'est pas inactive
+	if (!__atomic_load_n(&cnx->occupee, __ATOMIC_ACQUIRE)) {
+		if (maintenant - activite >= (uint64_t)delaiInactivite || cnx->sock.morte) {
+			shutdown(cnx->sock.fd, SHUT_RDWR);
+			return;
+		}
+		// Sonde unique par silence ; des octets encore en attente d'émission signalent
+		// déjà un pair qui ne lit plus : l'échéance s'en chargera
+		if (sonde != NULL && maintenant - activite >= (uint64_t)delaiSonde && cnx->sondee <= activite
+			&& __atomic_load_n(&cnx->tx.octets, __ATOMIC_RELAXED) == 0
+			&& ioctl(cnx->sock.fd, SIOCOUTQ, &enAttente) == 0 && enAttente == 0) {
+			sonde(cnx);
+			cnx->sondee = maintenant;
+			if (cnx->sock.morte) {
+				shutdown(cnx->sock.fd, SHUT_RDWR);
+				return;
+			}
+		}
+	}
+	echeance = activite + delaiInactivite;
+	if (sonde != NULL && cnx->sondee <= activite && activite + delaiSonde < echeance) echeance = activite + delaiSonde;
+	armerMinuteur(&b->roue, m, echeance > maintenant ? echeance - maintenant : 0, expirerCnx, b);
+}
+/**
+ *	\fn			static void surveillerCnx(boucle_t *b, connexion_t *cnx)
+ *	\brief		Arme la surveillance d'inactivité d'une nouvelle connexion
+ */
+static void surveillerCnx(boucle_t *b, connexion_t *cnx) {
+	int delai = (sonde != NULL && delaiSonde < delaiInactivite) ? delaiSonde : delaiInactivite;
+
+	cnx->activite = horlogeMs();
+	if (delaiInactivite <= 0) return;
+	CHECK_ZERO(pthread_mutex_lock(&b->verrouRoue), "pthread_mutex_lock");
+	armerMinuteur(&b->roue, &cnx->inactivite, delai, expirerCnx, b);
+	CHECK_ZERO(pthread_mutex_unlock(&b->verrouRoue), "pthread_mutex_unlock");
+}
+/**
+ *	\fn			static int avancerRoueBoucle(boucle_t *b)
+ *	\brief		Traite les échéances d'inactivité échues
+ *	\return		délai (ms) avant le prochain tick, -1 si les connexions ne sont pas surveillées
+ *	\note		Roue vide : un travailleur du pool peut y armer un minuteur pendant l'attente,
+ *				la boucle se réveille donc tout de même à chaque tick
+ */
+static int avancerRoueBoucle(boucle_t *b) {
+	int delai;
+
+	if (delaiInactivite <= 0) return -1;
+	CHECK_ZERO(pthread_mutex_lock(&b->verrouRoue), "pthread_mutex_lock");
+	avancerRoue(&b->roue);
+	delai = delaiRoue(&b->roue);
+	CHECK_ZERO(pthread_mutex_unlock(&b->verrouRoue), "pthread_mutex_unlock");
+	return delai == -1 ? RESOLUTION_INACTIVITE_MS : delai;
+}
+/**
+ *	\fn			static void fermerCnx(boucle_t *b, connexion_t *cnx)
+ *	\brief		Ferme une connexion et libère son état
+ */
+static void fermerCnx(boucle_t *b, connexion_t *cnx) {
+	// Avant la fermeture : la roue n'agit jamais sur une socket fermée ou libérée
+	CHECK_ZERO(pthread_mutex_lock(&b->verrouRoue), "pthread_mutex_lock");
+	annulerMinuteur(&b->roue, &cnx->inactivite);
+	CHECK_ZERO(pthread_mutex_unlock(&b->verrouRoue), "pthread_mutex_unlock");
+	// Avant la fermeture : aucun émetteur n'écrit plus sur le descripteur, réutilisable ensuite
+	fermerFileEmission(&cnx->sock);
+	if (!cnx->fermee) {
+		if (b->fermer != NULL) b->fermer(cnx);
+		else CHECK(close(cnx->sock.fd), "--close()--");
+	}
+	// Fermée, la socket a quitté epfdTx : attendre la fin d'une vidange qui l'aurait déjà relevée
+	CHECK_ZERO(pthread_mutex_lock(&b->verrouTx), "pthread_mutex_lock");
+	CHECK_ZERO(pthread_mutex_unlock(&b->verrouTx), "pthread_mutex_unlock");
+	libererTrame(&cnx->sock);
+	free(cnx->rx);
+	free(cnx);
+}
+/**
+ *	\fn			static int accepterFd(boucle_t *b, struct sockaddr_in *clt)
+ *	\brief		Accepte une connexion en attente (socket non bloquante)
+ *	\return		La socket de dialogue, -1 s'il n'y a plus rien à accepter
+ */
+static int accepterFd(boucle_t *b, struct sockaddr_in *clt) {
+	socklen_t cltLen;
+	int fd;
+
+	while (1) {
+		cltLen = sizeof(*clt);
+		fd = accept4(b->sockEcoute.fd, (struct sockaddr *)clt, &cltLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd != -1) return fd;
+		if (errno == EINTR || errno == ECONNABORTED) continue;
+		// EAGAIN : plus rien à accepter (ou une autre boucle l'a fait)
+		if (errno != EAGAIN && errno != EWOULDBLOCK) perror("--accept4()--");
+		return -1;
+	}
+}
+/**
+ *	\fn			static void accepterCnx(boucle_t *b)
+ *	\brief		Accepte toutes les connexions en attente et les inscrit dans la boucle
+ */
+static void accepterCnx(boucle_t *b) {
+	struct sockaddr_in clt;
+	struct epoll_event ev;
+	connexion_t *cnx;
+	int fd;
+
+	while ((fd = accepterFd(b, &clt)) != -1) {
+		if ((cnx = calloc(1, sizeof(connexion_t))) == NULL) {
+			perror("--calloc()--");
+			close(fd);
+			continue;
+		}
+		cnx->sock.fd = fd;
+		cnx->sock.mode = SOCK_STREAM;
+		cnx->sock.addrDst = clt;
+		surveillerCnx(b, cnx);
+		inscrireEmission(b, cnx);
+
+		ev.events = EPOLLIN | EPOLLRDHUP;
+		ev.data.ptr = cnx;
+		CHECK(epoll_ctl(b->epfd, EPOLL_CTL_ADD, fd, &ev), "--epoll_ctl()--");
+	}
+}
+/**
+ *	\fn			static void lireCnx(boucle_t *b, connexion_t *cnx, char *buff)
+ *	\brief		Lit les octets disponibles sur une connexion et traite chaque message complet
+ *	\param 		buff : tampon de travail de la boucle (MAX_RX_TRAME + TAILLE_LECTURE octets)
+ *	\return		0 si la connexion a été fermée (et libérée), 1 sinon
+ *	\note		Les messages sont délimités selon le mode de trame de la socket (cf. extraireTrame())
+ */
+static int lireCnx(boucle_t *b, connexion_t *cnx, char *buff) {
+	int nbOctets, total, deb, taille;
+	char *msg;
+
+	// Reprendre le début de message reçu lors d'une lecture précédente
+	total = cnx->rxLen;
+	if (total > 0) memcpy(buff, cnx->rx, total);
+	free(cnx->rx);
+	cnx->rx = NULL;
+	cnx->rxLen = 0;
+
+	nbOctets = read(cnx->sock.fd, buff + total, TAILLE_LECTURE);
+	if (nbOctets == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+		nbOctets = 0;
+		if (total == 0) return 1;
+	}
+	else if (nbOctets <= 0) {
+		fermerCnx(b, cnx);
+		return 0;
+	}
+	else __atomic_store_n(&cnx->activite, horlogeMs(), __ATOMIC_RELAXED);
+	total += nbOctets;
+
+	// Traiter chaque message complet
+	for (deb = 0; (taille = extraireTrame(buff + deb, total - deb, cnx->sock.trame, &msg)) > 0; deb += taille) {
+		b->traiter(cnx, msg, cnx->sock.trame == TRAME_LONGUEUR ? taille - TAILLE_ENTETE : taille);
+		// Connexion fermée par l'application, ou morte sur une erreur d'émission (cf. envoyerSts())
+		if (cnx->fermee || cnx->sock.morte) {
+			fermerCnx(b, cnx);
+			return 0;
+		}
+	}
+	if (taille == -1) {
+		fprintf(stderr, "Message trop long sur la socket [%d]\n", cnx->sock.fd);
+		fermerCnx(b, cnx);
+		return 0;
+	}
+
+	// Conserver le message incomplet (moins d'une trame : tient dans MAX_RX_TRAME)
+	if (deb < total) {
+		if ((cnx->rx = malloc(total - deb)) == NULL) {
+			perror("--malloc()--");
+			fermerCnx(b, cnx);
+			return 0;
+		}
+		memcpy(cnx->rx, buff + deb, total - deb);
+		cnx->rxLen = total - deb;
+	}
+	return 1;
+}
+/**
+ *	\fn			static void *boucle(void *arg)
+ *	\brief		Corps d'un thread de la boucle d'événements
+ */
+static void *boucle(void *arg) {
+	boucle_t *b = (boucle_t *)arg;
+	struct epoll_event evts[MAX_EVTS];
+	static __thread char buff[MAX_RX_TRAME + TAILLE_LECTURE];
+	int nbEvts, delai = -1;
+
+	while (1) {
+		nbEvts = epoll_wait(b->epfd, evts, MAX_EVTS, delai);
+		if (nbEvts == -1 && errno == EINTR) continue;
+		CHECK(nbEvts, "--epoll_wait()--");
+		for (int i = 0; i < nbEvts; i++) {
+			if (evts[i].data.ptr == NULL) accepterCnx(b);
+			else if (evts[i].data.ptr == b) viderCnxs(b);
+			else lireCnx(b, (connexion_t *)evts[i].data.ptr, buff);
+		}
+		delai = avancerRoueBoucle(b);
+	}
+	return NULL;
+}
+
+void lancerBoucles(socket_t sockEcoute, int nbThreads, pFctMess traiter, pFctCnx fermer) {
+	pthread_t th;
+	pthread_attr_t attr;
+	struct epoll_event ev;
+	boucle_t *boucles;
+	int flags;
+
+	if (nbThreads <= 0) nbThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nbThreads <= 0) nbThreads = 1;
+
+	CHECK(flags = fcntl(sockEcoute.fd, F_GETFL), "--fcntl()--");
+	CHECK(fcntl(sockEcoute.fd, F_SETFL, flags | O_NONBLOCK), "--fcntl()--");
+
+	if ((boucles = calloc(nbThreads, sizeof(boucle_t))) == NULL) {
+		perror("--calloc()--");
+		exit(-1);
+	}
+	CHECK_ZERO(pthread_attr_init(&attr), "pthread_attr_init");
+	CHECK_ZERO(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED), "pthread_attr_setdetachstate");
+
+	for (int i = 0; i < nbThreads; i++) {
+		boucles[i].sockEcoute = sockEcoute;
+		boucles[i].traiter = traiter;
+		boucles[i].fermer = fermer;
+		initRoueBoucle(&boucles[i]);
+		CHECK(boucles[i].epfd = epoll_create1(EPOLL_CLOEXEC), "--epoll_create1()--");
+		initEmissionBoucle(&boucles[i]);
+
+		// Chaque boucle surveille la socket d'écoute, un seul thread est réveillé par connexion
+		ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+		ev.data.ptr = NULL;
+		CHECK(epoll_ctl(boucles[i].epfd, EPOLL_CTL_ADD, sockEcoute.fd, &ev), "--epoll_ctl()--");
+
+		if (i > 0) CHECK_ZERO(pthread_create(&th, &attr, boucle, &boucles[i]), "pthread_create");
+	}
+	pthread_attr_destroy(&attr);
+	boucle(&boucles[0]);
+}
+/*
+*****************************************************************************************
+ *	\noop		P O O L   DE   T R A V A I L L E U R S
+ */
+/**
+ *	\fn			static void deposer(fileTaches_t *f, const tache_t *t)
+ *	\brief		Ajoute une tâche du côté des plus récentes (la file double si elle est pleine)
+ */
+static void deposer(fileTaches_t *f, const tache_t *t) {
+	tache_t *taches;
+
+	CHECK_ZERO(pthread_mutex_lock(&f->verrou), "pthread_mutex_lock");
+	if (f->nb == f->capacite) {
+		if ((taches = malloc(2 * f->capacite * sizeof(tache_t))) == NULL) {
+			perror("--malloc()--");
+			exit(-1);
+		}
+		for (unsigned int i = 0; i < f->nb; i++) taches[i] = f->taches[(f->deb + i) & (f->capacite - 1)];
+		free(f->taches);
+		f->taches = taches;
+		f->capacite *= 2;
+		f->deb = 0;
+	}
+	f->taches[(f->deb + f->nb++) & (f->capacite - 1)] = *t;
+	CHECK_ZERO(pthread_mutex_unlock(&f->verrou), "pthread_mutex_unlock");
+}
+/**
+ *	\fn			static int retirer(fileTaches_t *f, tache_t *t, int voler)
+ *	\brief		Retire la tâche la plus récente (propriétaire) ou la plus ancienne (vol)
+ *	\return		1 si une tâche a été retirée, 0 si la file est vide
+ */
+static int retirer(fileTaches_t *f, tache_t *t, int voler) {
+	int ok = 0;
+
+	// Lecture sans verrou : une file vide n'est pas verrouillée pour rien
+	if (__atomic_load_n(&f->nb, __ATOMIC_RELAXED) == 0) return 0;
+	CHECK_ZERO(pthread_mutex_lock(&f->verrou), "pthread_mutex_lock");
+	if (f->nb > 0) {
+		if (voler) {
+			*t = f->taches[f->deb];
+			f->deb = (f->deb + 1) & (f->capacite - 1);
+		}
+		else *t = f->taches[(f->deb + f->nb - 1) & (f->capacite - 1)];
+		f->nb--;
+		ok = 1;
+	}
+	CHECK_ZERO(pthread_mutex_unlock(&f->verrou), "pthread_mutex_unlock");
+	return ok;
+}
+/**
+ *	\fn			static int prendre(pool_t *p, int num, tache_t *t)
+ *	\brief		Prend une tâche dans sa file, sinon en vole une aux autres travailleurs
+ *	\return		1 si une tâche a été prise, 0 si toutes les files sont vides
+ */
+static int prendre(pool_t *p, int num, tache_t *t) {
+	if (retirer(&p->files[num], t, 0)) return 1;
+	for (int k = 1; k < p->nbTravailleurs; k++)
+		if (retirer(&p->files[(num + k) % p->nbTravailleurs], t, 1)) return 1;
+	return 0;
+}
+/**
+ *	\fn			static void executer(pool_t *p, tache_t *t, char *buff)
+ *	\brief		Inscrit une nouvelle connexion, ou lit une connexion prête puis la réarme
+ *	\note		EPOLLONESHOT : une connexion n'est servie que par un travailleur à la fois
+ */
+static void executer(pool_t *p, tache_t *t, char *buff) {
+	struct epoll_event ev = {EPOLLIN | EPOLLRDHUP | EPOLLONESHOT};
+
+	if (t->cnx == NULL) {
+		if ((ev.data.ptr = calloc(1, sizeof(connexion_t))) == NULL) {
+			perror("--calloc()--");
+			close(t->sock.fd);
+			return;
+		}
+		((connexion_t *)ev.data.ptr)->sock = t->sock;
+		surveillerCnx(&p->b, (connexion_t *)ev.data.ptr);
+		inscrireEmission(&p->b, (connexion_t *)ev.data.ptr);
+		CHECK(epoll_ctl(p->b.epfd, EPOLL_CTL_ADD, t->sock.fd, &ev), "--epoll_ctl()--");
+		return;
+	}
+	if (!lireCnx(&p->b, t->cnx, buff)) return;
+	// Rendue à la boucle : la roue peut de nouveau la sonder ou la fermer
+	__atomic_store_n(&t->cnx->occupee, 0, __ATOMIC_RELEASE);
+	ev.data.ptr = t->cnx;
+	CHECK(epoll_ctl(p->b.epfd, EPOLL_CTL_MOD, t->cnx->sock.fd, &ev), "--epoll_ctl()--");
+}
+/**
+ *	\fn			static void *travailler(void *arg)
+ *	\brief		Corps d'un travailleur : exécute les tâches, dort quand il n'y en a plus
+ */
+static void *travailler(void *arg) {
+	travailleur_t *w = (travailleur_t *)arg;
+	pool_t *p = w->pool;
+	static __thread char buff[MAX_RX_TRAME + TAILLE_LECTURE];
+	tache_t t;
+
+	while (1) {
+		if (prendre(p, w->num, &t)) {
+			__atomic_fetch_sub(&p->nbTaches, 1, __ATOMIC_RELAXED);
+			executer(p, &t, buff);
+			continue;
+		}
+		CHECK_ZERO(pthread_mutex_lock(&p->verrouAttente), "pthread_mutex_lock");
+		while (__atomic_load_n(&p->nbTaches, __ATOMIC_RELAXED) <= 0)
+			CHECK_ZERO(pthread_cond_wait(&p->travail, &p->verrouAttente), "pthread_cond_wait");
+		CHECK_ZERO(pthread_mutex_unlock(&p->verrouAttente), "pthread_mutex_unlock");
+	}
+	return NULL;
+}
+
+void lancerPool(socket_t sockEcoute, int nbTravailleurs, pFctMess traiter, pFctCnx fermer) {
+	pthread_t th;
+	pthread_attr_t attr;
+	struct epoll_event ev, evts[MAX_EVTS];
+	travailleur_t *travailleurs;
+	pool_t p = {.b = {.sockEcoute = sockEcoute, .traiter = traiter, .fermer = fermer},
+		.verrouAttente = PTHREAD_MUTEX_INITIALIZER, .travail = PTHREAD_COND_INITIALIZER};
+	tache_t t;
+	unsigned int suivant = 0;
+	int flags, nbEvts, nbDeposees, delai = -1;
+
+	if (nbTravailleurs <= 0) nbTravailleurs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nbTravailleurs <= 0) nbTravailleurs = 1;
+	p.nbTravailleurs = nbTravailleurs;
+
+	CHECK(flags = fcntl(sockEcoute.fd, F_GETFL), "--fcntl()--");
+	CHECK(fcntl(sockEcoute.fd, F_SETFL, flags | O_NONBLOCK), "--fcntl()--");
+	CHECK(p.b.epfd = epoll_create1(EPOLL_CLOEXEC), "--epoll_create1()--");
+	initRoueBoucle(&p.b);
+	initEmissionBoucle(&p.b);
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	CHECK(epoll_ctl(p.b.epfd, EPOLL_CTL_ADD, sockEcoute.fd, &ev), "--epoll_ctl()--");
+
+	// Toutes les allocations et créations de threads ont lieu avant la première connexion
+	if ((p.files = aligned_alloc(64, nbTravailleurs * sizeof(fileTaches_t))) == NULL
+		|| (travailleurs = calloc(nbTravailleurs, sizeof(travailleur_t))) == NULL) {
+		perror("--malloc()--");
+		exit(-1);
+	}
+	CHECK_ZERO(pthread_attr_init(&attr), "pthread_attr_init");
+	CHECK_ZERO(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED), "pthread_attr_setdetachstate");
+	for (int i = 0; i < nbTravailleurs; i++) {
+		memset(&p.files[i], 0, sizeof(fileTaches_t));
+		CHECK_ZERO(pthread_mutex_init(&p.files[i].verrou, NULL), "pthread_mutex_init");
+		p.files[i].capacite = CAPACITE_FILE;
+		if ((p.files[i].taches = malloc(CAPACITE_FILE * sizeof(tache_t))) == NULL) {
+			perror("--malloc()--");
+			exit(-1);
+		}
+		travailleurs[i].pool = &p;
+		travailleurs[i].num = i;
+		CHECK_ZERO(pthread_create(&th, &attr, travailler, &travailleurs[i]), "pthread_create");
+	}
+	pthread_attr_destroy(&attr);
+
+	// Thread appelant : accepte et répartit les connexions prêtes entre les files
+	while (1) {
+		nbEvts = epoll_wait(p.b.epfd, evts, MAX_EVTS, delai);
+		if (nbEvts == -1 && errno == EINTR) continue;
+		CHECK(nbEvts, "--epoll_wait()--");
+		nbDeposees = 0;
+		for (int i = 0; i < nbEvts; i++) {
+			// Vidange par le thread de la boucle : quelques send() sans attente
+			if (evts[i].data.ptr == &p.b) viderCnxs(&p.b);
+			else if (evts[i].data.ptr == NULL) {
+				t.cnx = NULL;
+				memset(&t.sock, 0, sizeof(socket_t));
+				t.sock.mode = SOCK_STREAM;
+				while ((t.sock.fd = accepterFd(&p.b, &t.sock.addrDst)) != -1) {
+					deposer(&p.files[suivant++ % nbTravailleurs], &t);
+					nbDeposees++;
+				}
+			}
+			else {
+				t.cnx = (connexion_t *)evts[i].data.ptr;
+				__atomic_store_n(&t.cnx->occupee, 1, __ATOMIC_RELAXED);
+				deposer(&p.files[suivant++ % nbTravailleurs], &t);
+				nbDeposees++;
+			}
+		}
+		// Après les dépôts : une connexion prête n'est jamais vue inactive
+		delai = avancerRoueBoucle(&p.b);
+		if (nbDeposees == 0) continue;
+		CHECK_ZERO(pthread_mutex_lock(&p.verrouAttente), "pthread_mutex_lock");
+		__atomic_fetch_add(&p.nbTaches, nbDeposees, __ATOMIC_RELAXED);
+		if (nbDeposees == 1) {
+			CHECK_ZERO(pthread_cond_signal(&p.travail), "pthread_cond_signal");
+		}
+		else {
+			CHECK_ZERO(pthread_cond_broadcast(&p.travail), "pthread_cond_broadcast");
+		}
+		CHECK_ZERO(pthread_mutex_unlock(&p.verrouAttente), "pthread_mutex_unlock");
+	}
+}
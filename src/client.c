@@ -60,7 +60,7 @@ void threadClient(void){
     socket_t saServer;
 
     requete_t request;
-    reponse_t response;
+    reponse_t response = {0};
     
 
     // Connexion avec le serveur :
@@ -96,7 +96,7 @@ void waitForRequest(socket_t *sockEch, requete_t *request, requeteList_t request
     request->idReq = -1;
 
     while (requete.idReq != requestCode){
-        recevoir(sockEch, request, str2req);
+        recevoirReq(sockEch, request);
 
         if (requete.idReq != requestCode){
 
@@ -116,36 +116,51 @@ void waitForRequest(socket_t *sockEch, requete_t *request, requeteList_t request
 
 
 
-void gameRequestHandler(socket_t *sockEch, requete_t *request, player_t *currentPlayer){
+// traitements des requêtes de jeu (cf. pFctTraiter) :
+// in = requête reçue, ctx = socket du serveur, out = joueur courant
+static dispatch_t traitementsClient;
 
-    while (1){
+void traiterEnvoiDeck(generic in, generic ctx, generic out){
+    getCards(ctx, out);
+}
 
-        recevoir(sockEch, request, str2req);
+void traiterEnvoiPli(generic in, generic ctx, generic out){
+    getPli();
+}
 
-        switch (request->idReq){
+void traiterEnvoiAtout(generic in, generic ctx, generic out){
+    keepTrump();
+}
 
-            case REQ_ENVOI_DECK:
-                getCards(sockEch, currentPlayer);
-                break;
+void traiterFinPartie(generic in, generic ctx, generic out){
+    // + message, option pour relancer etc... ?
+    afficherScore();
+}
 
-            case REQ_ENVOI_PLI:
-                getPli();
-                break;
 
-            case REQ_ENVOI_ATOUT:
-                keepTrump();
-                break;
+/**
+ *	\fn			void initTraitementsClient(void)
+ *	\brief		Enregistre les traitements des requêtes de jeu (à appeler au démarrage)
+ */
+void initTraitementsClient(void){
+    // requêtes non prévues par le client : ignorées
+    initDispatch(&traitementsClient, NULL);
+    enregistrerTraitement(&traitementsClient, REQ_ENVOI_DECK, "getCards", traiterEnvoiDeck);
+    enregistrerTraitement(&traitementsClient, REQ_ENVOI_PLI, "getPli", traiterEnvoiPli);
+    enregistrerTraitement(&traitementsClient, REQ_ENVOI_ATOUT, "keepTrump", traiterEnvoiAtout);
+    enregistrerTraitement(&traitementsClient, REQ_FIN_PARTIE, "afficherScore", traiterFinPartie);
+}
 
-            case REQ_FIN_PARTIE:
-                // + message, option pour relancer etc... ?
-                afficherScore();
 
-                break;
-            
-            default:
-                perror("Requête reçu non prévue par le client...");
-                break;
-        }
+void gameRequestHandler(socket_t *sockEch, requete_t *request, player_t *currentPlayer){
+
+    while (1){
+
+        recevoirReq(sockEch, request);
+
+        // sondes du serveur déjà répondues par recevoirReq() ; traitements enregistrés
+        // par initTraitementsClient()
+        dispatcher(&traitementsClient, request->idReq, request, sockEch, currentPlayer);
 
     }
 
@@ -158,7 +173,7 @@ void getCards(socket_t *sockEch, player_t *currentPlayer){
 
     player_t *player;
 
-    recevoir(sockEch, request, str2req);
+    recevoirReq(sockEch, request);
 
     response->idRep = REQ_OK;
     strcpy(response->verbRep, "OK");
@@ -179,7 +194,7 @@ void getPli(socket_t *sockEch, player_t *currentPlayer){
     pli_t pli;
 
 
-    recevoir(sockEch, request, str2req);
+    recevoirReq(sockEch, request);
 
     // Affichage du pli :
     printf("Le pli est : ...\n");
@@ -200,7 +215,7 @@ void keepTrump(){
 
     char userResponse;
 
-    recevoir(sockEch, request, str2req);
+    recevoirReq(sockEch, request);
 
     // Affichage du pli :
     printf("L'atout est : ...\n");
@@ -235,7 +250,7 @@ void playMove(socket_t *sockEch, player_t *currentPlayer){
 
     enum card selectedCard = -1;
 
-    reponse_t response;
+    reponse_t response = {0};
 
     printf("C'est à vous de jouer !\n\n");
 
@@ -0,0 +1,114 @@
+/**
+ * @file coroutine.c
+ * @brief Minimal stackful coroutines (ucontext) to suspend sequential game code
+ * @author Raphael ALLO
+ * @date 17/02/2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "../include/coroutine.h"
+
+/**
+ * @brief Coroutine running on this thread (NULL outside of any coroutine)
+ */
+static __thread coroutine_t *current = NULL;
+
+/**
+ * @brief Resumes a context saved by _setjmp, possibly on another stack (coroutineSaut.c)
+ */
+void coJump(jmp_buf env) __attribute__((noreturn));
+
+/**
+ * @brief Entry point of every coroutine: runs the body then returns to the caller
+ * @param[in] hi, lo Address of the coroutine split in two ints (makecontext only passes ints)
+ */
+static void trampoline(unsigned int hi, unsigned int lo){
+    coroutine_t *co = (coroutine_t *)(((uintptr_t)hi << 32) | lo);
+
+    co->fn(co->arg);
+    co->done = true;
+    co->value = NULL;
+    coJump(co->caller);
+}
+
+/**
+ * @brief Prepares a coroutine, the body starts at the first coResume
+ * @param[out] co Coroutine to prepare
+ * @param[in] fn Body of the coroutine
+ * @param[in] arg Argument of the body
+ * @param[in] stackSize Stack size in bytes (0 for CO_STACK_SIZE)
+ */
+void coInit(coroutine_t *co, void (*fn)(void *arg), void *arg, size_t stackSize){
+    uintptr_t p = (uintptr_t)co;
+
+    if (stackSize == 0) stackSize = CO_STACK_SIZE;
+    co->fn = fn;
+    co->arg = arg;
+    co->value = NULL;
+    co->started = false;
+    co->done = false;
+    if ((co->stack = malloc(stackSize)) == NULL || getcontext(&co->start) == -1)
+    {
+        perror("--coInit()--");
+        exit(EXIT_FAILURE);
+    }
+    co->start.uc_stack.ss_sp = co->stack;
+    co->start.uc_stack.ss_size = stackSize;
+    co->start.uc_link = NULL;
+    makecontext(&co->start, (void (*)(void))trampoline, 2, (unsigned int)(p >> 32), (unsigned int)p);
+}
+
+/**
+ * @brief Runs a coroutine until it yields or returns
+ * @param[in,out] co Coroutine not yet done
+ * @param[in] value Value returned to the coroutine by its coYield
+ * @return Value given to coYield, NULL once the coroutine is done
+ */
+void *coResume(coroutine_t *co, void *value){
+    coroutine_t *prev = current;
+
+    if (co->done) return NULL;
+    co->value = value;
+    current = co;
+    if (_setjmp(co->caller) == 0)
+    {
+        if (co->started) coJump(co->ctx);
+        co->started = true;
+        setcontext(&co->start);
+        perror("--setcontext()--");
+        exit(EXIT_FAILURE);
+    }
+    current = prev;
+    return co->value;
+}
+
+/**
+ * @brief Suspends the current coroutine and returns to coResume
+ * @param[in] value Value returned by coResume
+ * @return Value given to the next coResume
+ */
+void *coYield(void *value){
+    coroutine_t *co = current;
+
+    co->value = value;
+    if (_setjmp(co->ctx) == 0) coJump(co->caller);
+    return co->value;
+}
+
+/**
+ * @brief Coroutine running on the calling thread
+ * @return The coroutine, NULL outside of any coroutine
+ */
+coroutine_t *coSelf(void){
+    return current;
+}
+
+/**
+ * @brief Frees the stack of a coroutine
+ * @param[in,out] co Coroutine
+ */
+void coFree(coroutine_t *co){
+    free(co->stack);
+    co->stack = NULL;
+}
@@ -0,0 +1,18 @@
+/**
+ * @file coroutineSaut.c
+ * @brief Jump between coroutine stacks, compiled without _FORTIFY_SOURCE (see makefile)
+ * @details The fortified longjmp (__longjmp_chk) refuses to jump to another stack,
+ *          which is the whole point of a coroutine switch. Only this jump is built
+ *          without fortification, the rest of coroutine.c keeps it.
+ * @author Raphael ALLO
+ * @date 17/02/2026
+ */
+#include <setjmp.h>
+
+/**
+ * @brief Resumes a context saved by _setjmp, possibly on another stack
+ * @param[in] env Context to resume
+ */
+void coJump(jmp_buf env){
+    _longjmp(env, 1);
+}
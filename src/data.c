@@ -5,6 +5,7 @@
  *	\date		7 janvier 2026
  *	\version	1.0
  */
+#define _GNU_SOURCE		// sendmmsg(), recvmmsg()
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -13,6 +14,9 @@
 #include <stdarg.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <limits.h>
+#include <pthread.h>
 #include "../include/data.h"
 
 
@@ -28,6 +32,12 @@
  *				En cas d'erreur, il y a affichage du message adéquat et fin d'exécution  
  */
 #define CHECK(sts, msg) if ((sts)==-1) {perror(msg); exit(-1);}
+/**
+ *	\def		CHECK_NULL(sts, msg)
+ *	\brief		Macro-fonction qui vérifie que sts est égal à NULL (cas d'erreur)
+ *				En cas d'erreur, il y a affichage du message adéquat et fin d'exécution
+ */
+#define CHECK_NULL(sts, msg) if ((sts)==NULL) {perror(msg); exit(-1);}
 /**
  *	\def		PAUSE(msg)
  *	\brief		Macro-fonction qui affiche msg et attend une entrée clavier  
@@ -50,9 +60,17 @@
 #define RECV_FLAGS 	0
 /**
  *	\def		SEND_FLAGS
- *	\brief		Flags à utiliser en émission
+ *	\brief		Flags à utiliser en émission : un pair parti rend EPIPE au lieu de tuer
+ *				le processus par SIGPIPE
+ */
+#define SEND_FLAGS 	MSG_NOSIGNAL
+/**
+ *	\def		IOV_MAX
+ *	\brief		Nombre maximal de parties par appel à sendmsg() (valeur Linux si absente)
  */
-#define SEND_FLAGS 	0
+#ifndef IOV_MAX
+#define IOV_MAX		1024
+#endif
 /*
 *****************************************************************************************
  *	\noop		D E C L A R A T I O N   DES   V A R I A B L E S    G L O B A L E S
@@ -63,6 +81,15 @@
  *	\note		Variable externe : à déclarer par l'utilisateur
  */
 extern char *progName;
+/**
+ *	\var		reserveDiffusions
+ *	\brief		Tampons de diffusion libres, réutilisés sans allocation
+ */
+static struct {
+	diffusion_t *libres;		/**< pile des tampons libres					*/
+	int nbLibres;				/**< nombre de tampons de la pile				*/
+	pthread_mutex_t verrou;		/**< protège la pile							*/
+} reserveDiffusions = {NULL, 0, PTHREAD_MUTEX_INITIALIZER};
 /*
 *****************************************************************************************
  *	\noop		I M P L E M E N T A T I O N   DES   F O N C T I O N S
@@ -70,49 +97,175 @@ extern char *progName;
  */
 
 /**
- *	\fn			void envoyerMessDGRAM (socket_t *sockEch, char *msg, cchar *adrDest, short portDest)
+ *	\fn			int envoyerMessDGRAM (socket_t *sockEch, char *msg, int longueur, cchar *adrDest, short portDest)
  *	\brief		Envoi d'un message sur une socket en mode DGRAM
  *	\param 		sockEch : socket d'échange à utiliser pour l'envoi
  *	\param 		msg : message à envoyer
+ *	\param 		longueur : nombre d'octets de msg
  *	\param 		adrDest : adresse IP du destinataire
  *	\param 		portDest : port du destinataire
+ *	\result		0, -1 en cas d'erreur (errno positionné)
  */
-void envoyerMessDGRAM (socket_t *sockEch, char *msg, char *adrDest, short portDest) ;
+int envoyerMessDGRAM (socket_t *sockEch, char *msg, int longueur, char *adrDest, short portDest) ;
 /**
- *	\fn			void recevoirMessDGRAM (socket_t *sockEch, char *msg, int msgSize)
+ *	\fn			int recevoirMessDGRAM (socket_t *sockEch, char *msg, int msgSize)
  *	\brief		Réception d'un message sur une socket en mode DGRAM
  *	\param 		sockEch : socket d'échange à utiliser pour la réception
  *	\param 		msg : message reçu
  *	\param 		msgSize : taille de l'espace mémoire préalablement alloué à msg
- *	\result		paramètre modifié avec le message reçu
+ *	\result		nombre d'octets reçus, -1 en cas d'erreur (errno positionné)
  */
-void recevoirMessDGRAM (socket_t *sockEch, char *msg, int msgSize) ;
+int recevoirMessDGRAM (socket_t *sockEch, char *msg, int msgSize) ;
 /*
 *****************************************************************************************
  *	\noop		I M P L E M E N T A T I O N   DES   F O N C T I O N S
  *					M O D E    S T R E A M
  */
 /**
- *	\fn			void envoyerMessSTREAM (const socket_t *sockEch, char *msg)
+ *	\fn			int envoyerMessSTREAM (const socket_t *sockEch, char *msg, int longueur)
  *	\brief		Envoi d'un message sur une socket en mode STREAM
  *	\param 		sockEch : socket d'échange à utiliser pour l'envoi
  *	\param 		msg : message à envoyer
+ *	\param 		longueur : nombre d'octets de msg
+ *	\result		0, -1 en cas d'erreur (errno positionné)
 */
-void envoyerMessSTREAM (const socket_t *sockEch, char *msg) ;
+int envoyerMessSTREAM (const socket_t *sockEch, char *msg, int longueur) ;
 /**
- *	\fn			void recevoirMessSTREAM (const socket_t *sockEch, char *msg, int msgSize)
+ *	\fn			int recevoirMessSTREAM (const socket_t *sockEch, char *msg, int msgSize)
  *	\brief		Réception d'un message sur une socket en mode STREAM
  *	\param 		sockEch : socket d'échange à utiliser pour la réception
  *	\param 		msg	 : message reçu
  *	\param 		msgSize : taille de l'espace mémoire préalablement alloué à msg
- *	\result		paramètre modifié avec le message reçu
+ *	\result		nombre d'octets reçus, 0 si la connexion est fermée par le pair,
+ *				-1 en cas d'erreur (errno positionné)
+ */
+int recevoirMessSTREAM (const socket_t *sockEch, char *msg, int msgSize) ;
+/**
+ *	\fn			int envoyerOctets (const socket_t *sockEch, const char *data, int longueur)
+ *	\brief		Envoi de tous les octets d'un tampon sur une socket en mode STREAM
+ *	\param 		sockEch : socket d'échange à utiliser pour l'envoi
+ *	\param 		data : octets à envoyer
+ *	\param 		longueur : nombre d'octets à envoyer
+ *	\result		0, -1 en cas d'erreur (errno positionné, ETIMEDOUT si une socket non
+ *				bloquante reste pleine plus de DELAI_EMISSION_MS)
+ */
+int envoyerOctets (const socket_t *sockEch, const char *data, int longueur) ;
+/**
+ *	\fn			int envoyerVecteur (const socket_t *sockEch, struct iovec *iov, int nb)
+ *	\brief		Envoi bloquant de toutes les parties d'un vecteur, sans les recopier
+ *	\param 		iov : parties à émettre dans l'ordre (modifié par l'envoi)
+ *	\param 		nb : nombre de parties
+ *	\result		0, -1 en cas d'erreur (errno positionné, cf. envoyerOctets())
+ */
+int envoyerVecteur (const socket_t *sockEch, struct iovec *iov, int nb) ;
+/**
+ *	\fn			int envoyerFileVecteur (const socket_t *sockEch, diffusion_t *diff, struct iovec *iov, int nb)
+ *	\brief		Envoi non bloquant d'un vecteur sur une socket à file d'émission
+ *	\param 		diff : tampon contenant toutes les parties (référencé par la file), NULL
+ *				pour copier ce que le noyau n'accepte pas tout de suite
+ *	\result		cf. envoyerFile()
+ */
+int envoyerFileVecteur (const socket_t *sockEch, diffusion_t *diff, struct iovec *iov, int nb) ;
+/**
+ *	\fn			int envoyerFluxVecteur (const socket_t *sockEch, struct iovec *iov, int nb)
+ *	\brief		Envoi d'un vecteur par la file d'émission de la socket si elle en a une
+ *	\result		0, -1 en cas d'erreur (errno positionné)
+ */
+int envoyerFluxVecteur (const socket_t *sockEch, struct iovec *iov, int nb) ;
+/**
+ *	\fn			int envoyerFile (const socket_t *sockEch, diffusion_t *diff, const char *data, int longueur)
+ *	\brief		Envoi non bloquant sur une socket à file d'émission (cf. initFileEmission())
+ *	\param 		diff : tampon contenant data (référencé par la file), NULL pour copier data
+ *	\result		0 (octets émis ou mis en file), -1 en cas d'erreur (errno positionné,
+ *				ENOBUFS si le client est abandonné au-delà de seuilMax)
+ */
+int envoyerFile (const socket_t *sockEch, diffusion_t *diff, const char *data, int longueur) ;
+/**
+ *	\fn			int envoyerFlux (const socket_t *sockEch, const char *data, int longueur)
+ *	\brief		Envoi par la file d'émission de la socket si elle en a une, bloquant sinon
+ *	\result		0, -1 en cas d'erreur (errno positionné)
+ */
+int envoyerFlux (const socket_t *sockEch, const char *data, int longueur) ;
+/**
+ *	\fn			int envoyerTrameSTREAM (const socket_t *sockEch, char *trame, int len)
+ *	\brief		Envoi d'un message précédé de sa longueur sur une socket en mode STREAM
+ *	\param 		sockEch : socket d'échange à utiliser pour l'envoi
+ *	\param 		trame : TAILLE_ENTETE octets réservés pour l'en-tête suivis du message
+ *	\param 		len : longueur du message (sans l'en-tête)
+ *	\result		0, -1 en cas d'erreur (errno positionné)
+ */
+int envoyerTrameSTREAM (const socket_t *sockEch, char *trame, int len) ;
+/**
+ *	\fn			int recevoirTrameSTREAM (socket_t *sockEch, char *msg, int msgSize)
+ *	\brief		Réception d'un message précédé de sa longueur sur une socket en mode STREAM
+ *	\param 		sockEch : socket d'échange à utiliser pour la réception
+ *	\param 		msg	 : message reçu
+ *	\param 		msgSize : taille de l'espace mémoire préalablement alloué à msg
+ *	\result		longueur du message, 0 si la connexion est fermée par le pair,
+ *				-1 en cas d'erreur (errno positionné, EMSGSIZE pour une trame trop longue)
+ *	\note		Les octets reçus au-delà du message sont conservés dans sockEch->rx
+ *				pour les appels suivants
  */
-void recevoirMessSTREAM (const socket_t *sockEch, char *msg, int msgSize) ;
+int recevoirTrameSTREAM (socket_t *sockEch, char *msg, int msgSize) ;
 /*
 *****************************************************************************************
  *	\noop		I M P L E M E N T A T I O N   DES   F O N C T I O N S
  *					M O D E    D G R A M / S T R E A M
  */
+/**
+ *	\fn			static int serialiser(generic quoi, pFct serial, char *buff)
+ *	\brief		Serialisation d'une requête/réponse dans buff
+ *	\note		si le paramètre serial vaut NULL alors quoi est une chaîne de caractères
+ *	\result		nombre d'octets à émettre
+ */
+static int serialiser(generic quoi, pFct serial, char *buff) {
+	if (serial != NULL) return serial(quoi, buff);
+	strcpy(buff, (char *)quoi);
+	return strlen(buff) + 1;
+}
+/**
+ *	\fn			static int envoyerVa(socket_t *sockEch, generic quoi, pFct serial, va_list pArg)
+ *	\brief		Sérialisation et envoi d'une requête/réponse, commun à envoyer() et envoyerSts()
+ *	\param 		pArg : adresse IP et port du destinataire en mode DGRAM
+ *	\result		0, -1 en cas d'erreur (errno positionné)
+ */
+static int envoyerVa(socket_t *sockEch, generic quoi, pFct serial, va_list pArg) {
+	char trame[TAILLE_ENTETE + MAX_BUFFER];
+	char *buff = trame + TAILLE_ENTETE;	// buffer d'envoi, précédé de la place de l'en-tête
+	char *adrDest;
+	struct iovec partie;
+	int taille;
+
+	// Chaîne brute en STREAM : émise depuis la mémoire de l'appelant, sans recopie
+	if (serial == NULL && sockEch->mode==SOCK_STREAM) {
+		partie.iov_base = quoi;
+		partie.iov_len = strlen((char *)quoi) + 1;
+		return envoyerIov(sockEch, &partie, 1);
+	}
+	// Serialiser dans buff la requête/réponse à envoyer
+	taille = serialiser(quoi, serial, buff);
+
+	// Envoi : appel de la fonction adéquate selon le mode
+	if (sockEch->mode==SOCK_STREAM) {
+		if (sockEch->trame==TRAME_LONGUEUR) return envoyerTrameSTREAM(sockEch, trame, taille);
+		return envoyerMessSTREAM(sockEch, buff, taille);
+	}
+	adrDest = va_arg(pArg, char *);
+	return envoyerMessDGRAM(sockEch, buff, taille, adrDest, va_arg(pArg, int));
+}
+/**
+ *	\fn			static int recevoirBuff(socket_t *sockEch, char *buff)
+ *	\brief		Réception d'un message brut, commune à recevoir() et recevoirSts()
+ *	\result		nombre d'octets reçus, 0 si la connexion est fermée par le pair,
+ *				-1 en cas d'erreur (errno positionné)
+ */
+static int recevoirBuff(socket_t *sockEch, char *buff) {
+	if (sockEch->mode==SOCK_STREAM) {
+		if (sockEch->trame==TRAME_LONGUEUR) return recevoirTrameSTREAM(sockEch, buff, MAX_BUFFER);
+		return recevoirMessSTREAM(sockEch, buff, MAX_BUFFER);
+	}
+	return recevoirMessDGRAM(sockEch, buff, MAX_BUFFER);
+}
 /**
  *	\fn			void envoyer(socket_t *sockEch, generic quoi, pFct serial, ...)
  *	\brief		Envoi d'une requête/réponse sur une socket
@@ -124,23 +277,16 @@ void recevoirMessSTREAM (const socket_t *sockEch, char *msg, int msgSize) ;
  *	\result		paramètre sockEch modifié pour le mode DGRAM
  */
 void envoyer(socket_t *sockEch, generic quoi, pFct serial, ...) {
-	buffer_t buff;	// buffer d'envoi
-	
-	// Serialiser dans buff la requête/réponse à envoyer
-	if (serial != NULL) serial(quoi, buff);
-	else strcpy(buff , (char *)quoi);
-	
-	// Envoi : appel de la fonction adéquate selon le mode
-	if (sockEch->mode==SOCK_STREAM) envoyerMessSTREAM(sockEch, buff);
-	else {
-		va_list pArg;
-		va_start(pArg, serial);
-			envoyerMessDGRAM(sockEch, buff, va_arg(pArg, char *), va_arg(pArg, int));
-		va_end(pArg);
-		}	
+	va_list pArg;
+	int sts;
+
+	va_start(pArg, serial);
+		sts = envoyerVa(sockEch, quoi, serial, pArg);
+	va_end(pArg);
+	CHECK(sts, "send");
 }
 /**
- *	\fn			void recevoir(socket_t *sockEch, generic quoi, pFct deSerial)
+ *	\fn			void recevoir(socket_t *sockEch, generic quoi, pFctDeSerial deSerial)
  *	\brief		Réception d'une requête/réponse sur une socket
  *	\param 		sockEch : socket d'échange à utiliser pour la réception
  *	\param 		quoi : requête/réponse reçue après dé-serialisation du buffer de réception
@@ -149,54 +295,670 @@ void envoyer(socket_t *sockEch, generic quoi, pFct serial, ...) {
  *	\result		paramètre quoi modifié avec le requête/réponse reçue
  *				paramètre sockEch modifié pour le mode DGRAM
  */
-void recevoir(socket_t *sockEch, generic quoi, pFct deSerial) {
+void recevoir(socket_t *sockEch, generic quoi, pFctDeSerial deSerial) {
 	buffer_t buff;	// buffer de réception
-	
-	// Réception : appel de la fonction adéquate selon le mode
-	if (sockEch->mode==SOCK_STREAM) recevoirMessSTREAM(sockEch, buff, MAX_BUFFER);
-	else recevoirMessDGRAM(sockEch, buff, MAX_BUFFER);
+	int sts;
+
+	CHECK(sts = recevoirBuff(sockEch, buff), "Can't receive");
+	if (sts == 0) buff[0] = '\0';	// connexion fermée par le pair
 	// Dé-serialiser la requête/réponse
-	if (deSerial != NULL) deSerial(buff, quoi);
+	if (deSerial != NULL) deSerial(buff, sts, quoi);
 	else strcpy((char * ) quoi, buff);
 }
+/**
+ *	\fn			int envoyerSts(socket_t *sockEch, generic quoi, pFct serial, ...)
+ *	\brief		Envoi d'une requête/réponse sans arrêt du processus en cas d'erreur
+ *	\result		0, -1 en cas d'erreur : errno est positionné et la socket est marquée morte
+ */
+int envoyerSts(socket_t *sockEch, generic quoi, pFct serial, ...) {
+	va_list pArg;
+	int sts;
+
+	if (sockEch->morte) {
+		errno = EPIPE;
+		return -1;
+	}
+	va_start(pArg, serial);
+		sts = envoyerVa(sockEch, quoi, serial, pArg);
+	va_end(pArg);
+	if (sts == -1) sockEch->morte = 1;
+	return sts;
+}
+/**
+ *	\fn			int recevoirSts(socket_t *sockEch, generic quoi, pFctDeSerial deSerial)
+ *	\brief		Réception d'une requête/réponse sans arrêt du processus en cas d'erreur
+ *	\result		0, -1 si la connexion est fermée par le pair ou en erreur : la socket est
+ *				alors marquée morte et quoi n'est pas modifié
+ */
+int recevoirSts(socket_t *sockEch, generic quoi, pFctDeSerial deSerial) {
+	buffer_t buff;	// buffer de réception
+	int sts;
+
+	if (sockEch->morte || (sts = recevoirBuff(sockEch, buff)) <= 0) {
+		sockEch->morte = 1;
+		return -1;
+	}
+	if (deSerial != NULL) deSerial(buff, sts, quoi);
+	else strcpy((char * ) quoi, buff);
+	return 0;
+}
+
+/**
+ *	\fn			int envoyerIov(socket_t *sockEch, const struct iovec parties[], int nb)
+ *	\brief		Envoi d'un message formé de plusieurs parties, sans tampon intermédiaire
+ *	\result		0, -1 en cas d'erreur : errno est positionné et la socket est marquée morte
+ */
+int envoyerIov(socket_t *sockEch, const struct iovec parties[], int nb) {
+	struct iovec iov[nb + 1];
+	uint32_t entete;
+	size_t taille = 0;
+	int n = 0, sts;
+
+	if (sockEch->morte) {
+		errno = EPIPE;
+		return -1;
+	}
+	for (int i = 0; i < nb; i++) taille += parties[i].iov_len;
+	// L'en-tête est la seule partie construite ici : la longueur est connue sans strlen()
+	if (sockEch->trame==TRAME_LONGUEUR) {
+		entete = htonl(taille);
+		iov[n].iov_base = &entete;
+		iov[n++].iov_len = TAILLE_ENTETE;
+	}
+	memcpy(iov + n, parties, nb * sizeof(struct iovec));
+	if ((sts = envoyerFluxVecteur(sockEch, iov, n + nb)) == -1) sockEch->morte = 1;
+	return sts;
+}
+/**
+ *	\fn			void envoyerLot(socket_t *sockEch, generic quoi[], int nb, pFct serial)
+ *	\brief		Envoi de plusieurs requêtes/réponses en un minimum d'appels à send()
+ *	\param 		sockEch : socket d'échange STREAM à utiliser pour l'envoi
+ *	\param 		quoi : tableau des requêtes/réponses à serialiser
+ *	\param 		nb : nombre d'éléments de quoi
+ *	\param 		serial : pointeur sur la fonction de serialisation d'une requête/réponse
+ *	\note		Les messages ne sont regroupés qu'en mode TRAME_LONGUEUR : en mode
+ *				TRAME_TEXTE le récepteur ne saurait pas les séparer
+ */
+void envoyerLot(socket_t *sockEch, generic quoi[], int nb, pFct serial) {
+	CHECK(envoyerLotSts(sockEch, quoi, nb, serial), "send");
+}
+/**
+ *	\fn			int envoyerLotSts(socket_t *sockEch, generic quoi[], int nb, pFct serial)
+ *	\brief		Envoi groupé sans arrêt du processus en cas d'erreur (cf. envoyerLot())
+ *	\result		0, -1 en cas d'erreur : errno est positionné et la socket est marquée morte
+ */
+int envoyerLotSts(socket_t *sockEch, generic quoi[], int nb, pFct serial) {
+	char lot[MAX_LOT];	// trames accumulées avant l'envoi
+	char *buff;
+	int len = 0, taille;
+	uint32_t entete;
+
+	if (sockEch->trame!=TRAME_LONGUEUR) {
+		for (int i = 0; i < nb; i++)
+			if (envoyerSts(sockEch, quoi[i], serial) == -1) return -1;
+		return 0;
+	}
+	if (sockEch->morte) {
+		errno = EPIPE;
+		return -1;
+	}
+	for (int i = 0; i < nb; i++) {
+		// Plus la place pour une trame de taille maximale : vider le lot
+		if (len + TAILLE_ENTETE + MAX_BUFFER > MAX_LOT) {
+			if (envoyerFlux(sockEch, lot, len) == -1) {
+				sockEch->morte = 1;
+				return -1;
+			}
+			len = 0;
+		}
+		buff = lot + len + TAILLE_ENTETE;
+		taille = serialiser(quoi[i], serial, buff);
+		entete = htonl(taille);
+		memcpy(lot + len, &entete, TAILLE_ENTETE);
+		len += TAILLE_ENTETE + taille;
+	}
+	if (len > 0 && envoyerFlux(sockEch, lot, len) == -1) {
+		sockEch->morte = 1;
+		return -1;
+	}
+	return 0;
+}
+/**
+ *	\fn			static diffusion_t *prendreTampon(void)
+ *	\brief		Tampon de diffusion pris dans la réserve (alloué si elle est vide)
+ *	\result		tampon détenu par l'appelant (une référence)
+ */
+static diffusion_t *prendreTampon(void) {
+	diffusion_t *diff;
+
+	pthread_mutex_lock(&reserveDiffusions.verrou);
+		if ((diff = reserveDiffusions.libres) != NULL) {
+			reserveDiffusions.libres = diff->suiv;
+			reserveDiffusions.nbLibres--;
+		}
+	pthread_mutex_unlock(&reserveDiffusions.verrou);
+	if (diff == NULL) CHECK_NULL(diff = malloc(sizeof(diffusion_t)), "malloc");
+	diff->refs = 1;
+	return diff;
+}
+/**
+ *	\fn			diffusion_t *creerDiffusion(generic quoi, pFct serial)
+ *	\brief		Sérialisation unique d'une requête/réponse destinée à plusieurs sockets
+ *	\result		tampon pris dans la réserve, détenu par l'appelant (une référence)
+ */
+diffusion_t *creerDiffusion(generic quoi, pFct serial) {
+	diffusion_t *diff = prendreTampon();
+	char *buff;
+	uint32_t entete;
+
+	buff = diff->trame + TAILLE_ENTETE;
+	diff->len = serialiser(quoi, serial, buff);
+	entete = htonl(diff->len);
+	memcpy(diff->trame, &entete, TAILLE_ENTETE);
+	return diff;
+}
+/**
+ *	\fn			diffusion_t *prendreDiffusion(diffusion_t *diff)
+ *	\brief		Ajoute une référence à un tampon de diffusion (nouveau détenteur)
+ */
+diffusion_t *prendreDiffusion(diffusion_t *diff) {
+	__atomic_fetch_add(&diff->refs, 1, __ATOMIC_RELAXED);
+	return diff;
+}
+/**
+ *	\fn			void rendreDiffusion(diffusion_t *diff)
+ *	\brief		Rend une référence, le tampon retourne à la réserve après la dernière
+ */
+void rendreDiffusion(diffusion_t *diff) {
+	// Libération : les écritures des autres détenteurs doivent être visibles du dernier
+	if (__atomic_sub_fetch(&diff->refs, 1, __ATOMIC_ACQ_REL) > 0) return;
+	pthread_mutex_lock(&reserveDiffusions.verrou);
+		if (reserveDiffusions.nbLibres < MAX_DIFFUSIONS_LIBRES) {
+			diff->suiv = reserveDiffusions.libres;
+			reserveDiffusions.libres = diff;
+			reserveDiffusions.nbLibres++;
+			diff = NULL;
+		}
+	pthread_mutex_unlock(&reserveDiffusions.verrou);
+	free(diff);
+}
+/**
+ *	\fn			int diffuser(diffusion_t *diff, socket_t *socks[], int nb)
+ *	\brief		Envoi d'un message déjà sérialisé sur plusieurs sockets STREAM
+ *	\result		nombre de sockets servies, les sockets en erreur sont marquées mortes
+ */
+int diffuser(diffusion_t *diff, socket_t *socks[], int nb) {
+	int nbServies = 0, sts, deb;
+
+	for (int i = 0; i < nb; i++) {
+		if (socks[i] == NULL || socks[i]->morte) continue;
+		// Mêmes octets pour tous : seul le début d'émission dépend de la délimitation
+		deb = (socks[i]->trame == TRAME_LONGUEUR) ? 0 : TAILLE_ENTETE;
+		// Socket à file : le reste non émis référence le tampon partagé, sans copie
+		if (socks[i]->tx != NULL) sts = envoyerFile(socks[i], diff, diff->trame + deb, TAILLE_ENTETE + diff->len - deb);
+		else sts = envoyerOctets(socks[i], diff->trame + deb, TAILLE_ENTETE + diff->len - deb);
+		if (sts == -1) socks[i]->morte = 1;
+		else nbServies++;
+	}
+	return nbServies;
+}
+/**
+ *	\fn			void initFileEmission(socket_t *sockEch, fileEmission_t *tx, int seuilLent, int seuilMax)
+ *	\brief		Passe une socket STREAM non bloquante en émission par file
+ */
+void initFileEmission(socket_t *sockEch, fileEmission_t *tx, int seuilLent, int seuilMax) {
+	memset(tx, 0, sizeof(fileEmission_t));
+	pthread_mutex_init(&tx->verrou, NULL);
+	tx->seuilLent = seuilLent > 0 ? seuilLent : SEUIL_LENT_EMISSION;
+	tx->seuilMax = seuilMax > 0 ? seuilMax : SEUIL_MAX_EMISSION;
+	sockEch->tx = tx;
+}
+/**
+ *	\fn			static int mettreEnFile(const socket_t *sockEch, diffusion_t *diff, const char *data, int longueur)
+ *	\brief		Ajoute le reste d'un message à la file d'émission (verrou de la file pris)
+ *	\param 		diff : tampon contenant data, référencé ; NULL pour copier data
+ *	\result		0, -1 si le client est abandonné (errno vaut ENOBUFS, la socket est coupée
+ *				pour que son propriétaire la ferme)
+ */
+static int mettreEnFile(const socket_t *sockEch, diffusion_t *diff, const char *data, int longueur) {
+	fileEmission_t *tx = sockEch->tx;
+	struct entreeEmission *e;
+	int taille;
+
+	if (tx->octets + longueur > tx->seuilMax
+		|| (tx->entrees == NULL && (tx->entrees = malloc(MAX_FILE_EMISSION * sizeof(struct entreeEmission))) == NULL)) {
+		// Client trop lent : il ne retient plus les autres, sa boucle le fermera
+		shutdown(sockEch->fd, SHUT_RDWR);
+		errno = ENOBUFS;
+		return -1;
+	}
+	while (longueur > 0) {
+		if (tx->nb == MAX_FILE_EMISSION) {
+			shutdown(sockEch->fd, SHUT_RDWR);
+			errno = ENOBUFS;
+			return -1;
+		}
+		e = &tx->entrees[(tx->deb + tx->nb) & (MAX_FILE_EMISSION - 1)];
+		if (diff != NULL) {
+			taille = longueur;
+			e->diff = prendreDiffusion(diff);
+			e->deb = data - diff->trame;
+		}
+		else {	// copie, par tampons de la réserve (un lot peut dépasser un tampon)
+			taille = longueur < TAILLE_ENTETE + MAX_BUFFER ? longueur : TAILLE_ENTETE + MAX_BUFFER;
+			e->diff = prendreTampon();
+			memcpy(e->diff->trame, data, taille);
+			e->deb = 0;
+		}
+		e->fin = e->deb + taille;
+		tx->nb++;
+		__atomic_store_n(&tx->octets, tx->octets + taille, __ATOMIC_RELAXED);
+		data += taille;
+		longueur -= taille;
+	}
+	if (tx->octets >= tx->seuilLent) __atomic_store_n(&tx->lente, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+/**
+ *	\fn			int viderFileEmission(socket_t *sockEch)
+ *	\brief		Emet ce que la socket accepte des messages en attente
+ *	\result		nombre d'octets encore en attente, -1 en cas d'erreur (errno positionné)
+ */
+int viderFileEmission(socket_t *sockEch) {
+	fileEmission_t *tx = sockEch->tx;
+	struct entreeEmission *e;
+	int nbOctets, reste;
+
+	if (tx == NULL) return 0;
+	pthread_mutex_lock(&tx->verrou);
+	while (!tx->fermee && tx->nb > 0) {
+		e = &tx->entrees[tx->deb];
+		nbOctets = send(sockEch->fd, e->diff->trame + e->deb, e->fin - e->deb, SEND_FLAGS | MSG_DONTWAIT);
+		if (nbOctets == -1) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			pthread_mutex_unlock(&tx->verrou);
+			return -1;
+		}
+		e->deb += nbOctets;
+		__atomic_store_n(&tx->octets, tx->octets - nbOctets, __ATOMIC_RELAXED);
+		if (e->deb < e->fin) continue;
+		rendreDiffusion(e->diff);
+		tx->deb = (tx->deb + 1) & (MAX_FILE_EMISSION - 1);
+		tx->nb--;
+	}
+	if (tx->lente && tx->octets <= tx->seuilLent / 2) __atomic_store_n(&tx->lente, 0, __ATOMIC_RELAXED);
+	reste = tx->octets;
+	pthread_mutex_unlock(&tx->verrou);
+	return reste;
+}
+/**
+ *	\fn			void fermerFileEmission(socket_t *sockEch)
+ *	\brief		Abandonne les messages en attente, à appeler avant la fermeture de la socket
+ */
+void fermerFileEmission(socket_t *sockEch) {
+	fileEmission_t *tx = sockEch->tx;
+
+	if (tx == NULL) return;
+	// Sous le verrou : aucun émetteur n'écrit plus ensuite sur ce descripteur (réutilisable)
+	pthread_mutex_lock(&tx->verrou);
+	for (; tx->nb > 0; tx->nb--, tx->deb = (tx->deb + 1) & (MAX_FILE_EMISSION - 1))
+		rendreDiffusion(tx->entrees[tx->deb].diff);
+	free(tx->entrees);
+	tx->entrees = NULL;
+	tx->octets = 0;
+	tx->fermee = 1;
+	pthread_mutex_unlock(&tx->verrou);
+}
+/**
+ *	\fn			int emissionLente(const socket_t *sockEch)
+ *	\brief		Indique si le client lit moins vite que le serveur ne lui écrit
+ */
+int emissionLente(const socket_t *sockEch) {
+	return sockEch->tx != NULL && __atomic_load_n(&sockEch->tx->lente, __ATOMIC_RELAXED);
+}
+/**
+ *	\fn			void modeTrame(socket_t *sockEch, int trame)
+ *	\brief		Choix de la délimitation des messages sur une socket STREAM
+ *	\param 		sockEch : socket d'échange
+ *	\param 		trame : TRAME_TEXTE ou TRAME_LONGUEUR
+ *	\note		Les deux extrémités doivent utiliser la même délimitation
+ */
+void modeTrame(socket_t *sockEch, int trame) {
+	sockEch->trame = trame;
+}
+/**
+ *	\fn			void libererTrame(socket_t *sockEch)
+ *	\brief		Libère le tampon de réassemblage d'une socket (à appeler à sa fermeture)
+ *	\param 		sockEch : socket d'échange
+ */
+void libererTrame(socket_t *sockEch) {
+	free(sockEch->rx);
+	sockEch->rx = NULL;
+}
+/**
+ *	\fn			int extraireTrame(const char *data, int len, int trame, char **msg)
+ *	\brief		Décodage du premier message complet d'une suite d'octets reçus
+ *	\param 		data : octets reçus
+ *	\param 		len : nombre d'octets de data
+ *	\param 		trame : délimitation utilisée (TRAME_TEXTE/TRAME_LONGUEUR)
+ *	\param 		msg : début du message dans data
+ *	\result		nombre d'octets consommés (en-tête compris), 0 si le message est incomplet,
+ *				-1 si la trame dépasse MAX_BUFFER
+ */
+int extraireTrame(const char *data, int len, int trame, char **msg) {
+	const char *fin;
+	uint32_t taille;
+
+	if (trame==TRAME_TEXTE) {
+		if ((fin = memchr(data, '\0', len)) == NULL) return (len >= MAX_BUFFER) ? -1 : 0;
+		if (fin - data >= MAX_BUFFER) return -1;
+		*msg = (char *)data;
+		return fin - data + 1;
+	}
+	if (len < TAILLE_ENTETE) return 0;
+	memcpy(&taille, data, TAILLE_ENTETE);
+	taille = ntohl(taille);
+	if (taille == 0 || taille > MAX_BUFFER) return -1;
+	if (len < TAILLE_ENTETE + (int)taille) return 0;
+	*msg = (char *)data + TAILLE_ENTETE;
+	return TAILLE_ENTETE + taille;
+}
+/**
+ *	\fn			int decoderTrames(const char *data, int len, int trame, char *msgs[], int max, int *consomme)
+ *	\brief		Décodage de tous les messages complets d'une suite d'octets reçus
+ *	\param 		data : octets reçus
+ *	\param 		len : nombre d'octets de data
+ *	\param 		trame : délimitation utilisée (TRAME_TEXTE/TRAME_LONGUEUR)
+ *	\param 		msgs : débuts des messages décodés dans data
+ *	\param 		max : nombre maximal de messages à décoder
+ *	\param 		consomme : nombre d'octets consommés par les messages décodés
+ *	\result		nombre de messages décodés, -1 si une trame dépasse MAX_BUFFER
+ */
+int decoderTrames(const char *data, int len, int trame, char *msgs[], int max, int *consomme) {
+	int nb = 0, taille;
+
+	*consomme = 0;
+	while (nb < max && (taille = extraireTrame(data + *consomme, len - *consomme, trame, &msgs[nb])) != 0) {
+		if (taille == -1) return -1;
+		*consomme += taille;
+		nb++;
+	}
+	return nb;
+}
 
 
 //////////////////////////////
 // Mes fonctions 			//
 //////////////////////////////
 
-void envoyerMessDGRAM (socket_t *sockEch, char *msg, char *adrDest, short portDest) {
-	int nbOctets;
-	struct sockaddr_in dest;
+int envoyerMessDGRAM (socket_t *sockEch, char *msg, int longueur, char *adrDest, short portDest) {
+	// Dernier destinataire résolu par ce thread : un client qui répond toujours au même
+	// pair ne refait pas inet_addr() à chaque datagramme
+	static __thread struct {
+		char adrIP[INET_ADDRSTRLEN];
+		struct sockaddr_in dest;
+	} dernier;
 
-	dest.sin_family = AF_INET;
-	dest.sin_port = htons(portDest);
-	dest.sin_addr.s_addr = inet_addr(adrDest);
-	memset(dest.sin_zero, 0, 8);
-	CHECK(nbOctets = sendto(sockEch->fd, msg, strlen(msg) + 1, SEND_FLAGS, (struct sockaddr *)&dest, sizeof(dest)), "sendTo DGRAM");
+	if (dernier.dest.sin_port != htons(portDest) || strncmp(dernier.adrIP, adrDest, INET_ADDRSTRLEN) != 0) {
+		adr2struct(&dernier.dest, adrDest, portDest);
+		strncpy(dernier.adrIP, adrDest, INET_ADDRSTRLEN - 1);
+	}
+	if (sendto(sockEch->fd, msg, longueur, SEND_FLAGS, (struct sockaddr *)&dernier.dest, sizeof(dernier.dest)) == -1) return -1;
+	return 0;
 }
 
 
-void recevoirMessDGRAM (socket_t *sockEch, char *msg, int msgSize) {
+int recevoirMessDGRAM (socket_t *sockEch, char *msg, int msgSize) {
 	int nbOctets;
 	struct sockaddr_in svc;
 	socklen_t svcLen = sizeof(svc);
-	CHECK(	nbOctets = recvfrom(sockEch->fd, msg, msgSize - 1, RECV_FLAGS,(struct sockaddr *)&svc, &svcLen), "recvfrom DGRAM");
 
+	if ((nbOctets = recvfrom(sockEch->fd, msg, msgSize - 1, RECV_FLAGS,(struct sockaddr *)&svc, &svcLen)) == -1) return -1;
 	sockEch->addrDst = svc;
-	
+	return nbOctets;
 }
+/**
+ *	\fn			static int envoyerMmsg(socket_t *sockEch, struct mmsghdr msgs[], int nb)
+ *	\brief		Emission de datagrammes préparés, sendmmsg() pouvant n'en prendre qu'une partie
+ *	\result		nombre de datagrammes émis, errno positionné s'il est inférieur à nb
+ */
+static int envoyerMmsg(socket_t *sockEch, struct mmsghdr msgs[], int nb) {
+	int nbEmis = 0, sts;
 
+	while (nbEmis < nb) {
+		sts = sendmmsg(sockEch->fd, msgs + nbEmis, nb - nbEmis, SEND_FLAGS);
+		if (sts == -1) {
+			if (errno == EINTR) continue;
+			break;
+		}
+		nbEmis += sts;
+	}
+	return nbEmis;
+}
+/**
+ *	\fn			static void adresserMmsg(struct mmsghdr *msg, struct iovec *iov, const struct sockaddr_in *dest)
+ *	\brief		Prépare l'en-tête d'un datagramme d'un lot
+ */
+static void adresserMmsg(struct mmsghdr *msg, struct iovec *iov, const struct sockaddr_in *dest) {
+	memset(msg, 0, sizeof(struct mmsghdr));
+	msg->msg_hdr.msg_name = (void *)dest;
+	msg->msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+	msg->msg_hdr.msg_iov = iov;
+	msg->msg_hdr.msg_iovlen = 1;
+}
+/**
+ *	\fn			int envoyerLotDGRAM(socket_t *sockEch, generic quoi[], const struct sockaddr_in dests[], int nb, pFct serial)
+ *	\brief		Envoi de plusieurs datagrammes par appel à sendmmsg()
+ */
+int envoyerLotDGRAM(socket_t *sockEch, generic quoi[], const struct sockaddr_in dests[], int nb, pFct serial) {
+	buffer_t buffs[LOT_DGRAM];
+	struct iovec iov[LOT_DGRAM];
+	struct mmsghdr msgs[LOT_DGRAM];
+	int nbEmis = 0, lot, sts;
 
-void envoyerMessSTREAM (const socket_t *sockEch, char *msg) {
-	int nbOctets;
-	int longueur = strlen(msg) + 1;
-	int totalEnvoye = 0;
-	while (totalEnvoye < longueur) {
-		CHECK(nbOctets = send(sockEch->fd, msg + totalEnvoye, longueur - totalEnvoye, SEND_FLAGS), "send STREAM");
-		totalEnvoye += nbOctets;
+	while (nbEmis < nb) {
+		lot = (nb - nbEmis < LOT_DGRAM) ? nb - nbEmis : LOT_DGRAM;
+		for (int i = 0; i < lot; i++) {
+			iov[i].iov_base = buffs[i];
+			iov[i].iov_len = serialiser(quoi[nbEmis + i], serial, buffs[i]);
+			adresserMmsg(&msgs[i], &iov[i], &dests[nbEmis + i]);
+		}
+		sts = envoyerMmsg(sockEch, msgs, lot);
+		nbEmis += sts;
+		if (sts < lot) break;
+	}
+	return nbEmis;
+}
+/**
+ *	\fn			int diffuserDGRAM(socket_t *sockEch, diffusion_t *diff, const struct sockaddr_in dests[], int nb)
+ *	\brief		Envoi d'un message déjà sérialisé à plusieurs destinataires DGRAM
+ */
+int diffuserDGRAM(socket_t *sockEch, diffusion_t *diff, const struct sockaddr_in dests[], int nb) {
+	struct iovec iov = {diff->trame + TAILLE_ENTETE, diff->len};
+	struct mmsghdr msgs[LOT_DGRAM];
+	int nbEmis = 0, lot, sts;
+
+	while (nbEmis < nb) {
+		lot = (nb - nbEmis < LOT_DGRAM) ? nb - nbEmis : LOT_DGRAM;
+		for (int i = 0; i < lot; i++) adresserMmsg(&msgs[i], &iov, &dests[nbEmis + i]);
+		sts = envoyerMmsg(sockEch, msgs, lot);
+		nbEmis += sts;
+		if (sts < lot) break;
+	}
+	return nbEmis;
+}
+/**
+ *	\fn			int recevoirLotDGRAM(socket_t *sockEch, generic quoi[], struct sockaddr_in srcs[], int max, pFctDeSerial deSerial)
+ *	\brief		Réception de plusieurs datagrammes par appel à recvmmsg()
+ */
+int recevoirLotDGRAM(socket_t *sockEch, generic quoi[], struct sockaddr_in srcs[], int max, pFctDeSerial deSerial) {
+	buffer_t buffs[LOT_DGRAM];
+	struct iovec iov[LOT_DGRAM];
+	struct sockaddr_in adrs[LOT_DGRAM];
+	struct mmsghdr msgs[LOT_DGRAM];
+	int nbRecus = 0, lot, sts, len;
+
+	while (nbRecus < max) {
+		lot = (max - nbRecus < LOT_DGRAM) ? max - nbRecus : LOT_DGRAM;
+		for (int i = 0; i < lot; i++) {
+			iov[i].iov_base = buffs[i];
+			iov[i].iov_len = MAX_BUFFER - 1;
+			adresserMmsg(&msgs[i], &iov[i], &adrs[i]);
+		}
+		// Le premier lot attend un datagramme, les suivants ne vident que ce qui est arrivé
+		sts = recvmmsg(sockEch->fd, msgs, lot, nbRecus == 0 ? MSG_WAITFORONE : MSG_DONTWAIT, NULL);
+		if (sts == -1) {
+			if (errno == EINTR && nbRecus == 0) continue;
+			if (nbRecus == 0) return -1;
+			break;
+		}
+		for (int i = 0; i < sts; i++) {
+			len = msgs[i].msg_len;
+			buffs[i][len] = '\0';
+			if (deSerial != NULL) deSerial(buffs[i], len, quoi[nbRecus + i]);
+			else strcpy((char *)quoi[nbRecus + i], buffs[i]);
+			if (srcs != NULL) srcs[nbRecus + i] = adrs[i];
+		}
+		sockEch->addrDst = adrs[sts - 1];
+		nbRecus += sts;
+		if (sts < lot) break;
+	}
+	return nbRecus;
+}
+
+
+/**
+ *	\fn			static int avancerVecteur(struct iovec **iov, int *nb, size_t nbOctets)
+ *	\brief		Retire d'un vecteur les octets déjà émis
+ *	\result		1 s'il reste des octets à émettre, 0 sinon
+ */
+static int avancerVecteur(struct iovec **iov, int *nb, size_t nbOctets) {
+	while (*nb > 0 && nbOctets >= (*iov)->iov_len) {
+		nbOctets -= (*iov)->iov_len;
+		(*iov)++;
+		(*nb)--;
 	}
+	if (*nb == 0) return 0;
+	(*iov)->iov_base = (char *)(*iov)->iov_base + nbOctets;
+	(*iov)->iov_len -= nbOctets;
+	return 1;
+}
+/**
+ *	\fn			static ssize_t envoyerMsg(int fd, struct iovec *iov, int nb, int flags)
+ *	\brief		Un appel à sendmsg() sur les premières parties d'un vecteur (au plus IOV_MAX)
+ */
+static ssize_t envoyerMsg(int fd, struct iovec *iov, int nb, int flags) {
+	struct msghdr m = {.msg_iov = iov, .msg_iovlen = nb < IOV_MAX ? nb : IOV_MAX};
+
+	return sendmsg(fd, &m, flags);
 }
-void recevoirMessSTREAM (const socket_t * sockEch, char *msg, int msgSize) {
-    CHECK(read(sockEch->fd, msg, msgSize), "Can't receive");
+int envoyerVecteur (const socket_t *sockEch, struct iovec *iov, int nb) {
+	struct pollfd pfd = {sockEch->fd, POLLOUT, 0};
+	ssize_t nbOctets;
+
+	while (nb > 0) {
+		nbOctets = envoyerMsg(sockEch->fd, iov, nb, SEND_FLAGS);
+		if (nbOctets == -1) {
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+			// Socket non bloquante pleine : un pair qui ne lit plus n'immobilise pas l'émetteur
+			if ((nbOctets = poll(&pfd, 1, DELAI_EMISSION_MS)) == -1 && errno != EINTR) return -1;
+			if (nbOctets == 0) {
+				errno = ETIMEDOUT;
+				return -1;
+			}
+			continue;
+		}
+		avancerVecteur(&iov, &nb, nbOctets);
+	}
+	return 0;
+}
+int envoyerOctets (const socket_t *sockEch, const char *data, int longueur) {
+	struct iovec iov = {(char *)data, longueur};
+
+	return envoyerVecteur(sockEch, &iov, 1);
+}
+int envoyerFileVecteur (const socket_t *sockEch, diffusion_t *diff, struct iovec *iov, int nb) {
+	fileEmission_t *tx = sockEch->tx;
+	ssize_t nbOctets;
+	int sts = 0;
+
+	pthread_mutex_lock(&tx->verrou);
+	if (tx->fermee) {
+		pthread_mutex_unlock(&tx->verrou);
+		errno = EPIPE;
+		return -1;
+	}
+	// File vide : le noyau prend ce qu'il peut tout de suite, sinon l'ordre impose d'attendre son tour
+	while (tx->nb == 0 && nb > 0) {
+		nbOctets = envoyerMsg(sockEch->fd, iov, nb, SEND_FLAGS | MSG_DONTWAIT);
+		if (nbOctets == -1) {
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK) sts = -1;
+			break;
+		}
+		avancerVecteur(&iov, &nb, nbOctets);
+	}
+	for (; sts == 0 && nb > 0; iov++, nb--)
+		if (iov->iov_len > 0) sts = mettreEnFile(sockEch, diff, iov->iov_base, iov->iov_len);
+	pthread_mutex_unlock(&tx->verrou);
+	return sts;
+}
+int envoyerFile (const socket_t *sockEch, diffusion_t *diff, const char *data, int longueur) {
+	struct iovec iov = {(char *)data, longueur};
+
+	return envoyerFileVecteur(sockEch, diff, &iov, 1);
+}
+int envoyerFluxVecteur (const socket_t *sockEch, struct iovec *iov, int nb) {
+	if (sockEch->tx != NULL) return envoyerFileVecteur(sockEch, NULL, iov, nb);
+	return envoyerVecteur(sockEch, iov, nb);
+}
+int envoyerFlux (const socket_t *sockEch, const char *data, int longueur) {
+	struct iovec iov = {(char *)data, longueur};
+
+	return envoyerFluxVecteur(sockEch, &iov, 1);
+}
+int envoyerMessSTREAM (const socket_t *sockEch, char *msg, int longueur) {
+	return envoyerFlux(sockEch, msg, longueur);
+}
+int recevoirMessSTREAM (const socket_t * sockEch, char *msg, int msgSize) {
+	int nbOctets;
+
+	while ((nbOctets = read(sockEch->fd, msg, msgSize)) == -1 && errno == EINTR);
+	return nbOctets;
+}
+
+
+int envoyerTrameSTREAM (const socket_t *sockEch, char *trame, int len) {
+	uint32_t entete = htonl(len);
+	memcpy(trame, &entete, TAILLE_ENTETE);
+	return envoyerFlux(sockEch, trame, TAILLE_ENTETE + len);
+}
+int recevoirTrameSTREAM (socket_t *sockEch, char *msg, int msgSize) {
+	rxTrame_t *rx;
+	char *deb;
+	int nbOctets, taille;
+
+	if (sockEch->rx == NULL && (sockEch->rx = calloc(1, sizeof(rxTrame_t))) == NULL) return -1;
+	rx = sockEch->rx;
+	// Lire jusqu'à disposer d'une trame complète (elle a peut-être été reçue lors d'un appel précédent)
+	while ((taille = extraireTrame(rx->buff, rx->len, TRAME_LONGUEUR, &deb)) == 0) {
+		nbOctets = read(sockEch->fd, rx->buff + rx->len, MAX_RX_TRAME - rx->len);
+		if (nbOctets == -1 && errno == EINTR) continue;
+		if (nbOctets <= 0) {	// erreur, ou connexion fermée par le pair
+			msg[0] = '\0';
+			return nbOctets;
+		}
+		rx->len += nbOctets;
+	}
+	if (taille == -1 || taille - TAILLE_ENTETE > msgSize) {
+		fprintf(stderr, "recv trame STREAM : trame trop longue\n");
+		errno = EMSGSIZE;
+		return -1;
+	}
+	memcpy(msg, deb, taille - TAILLE_ENTETE);
+	rx->len -= taille;
+	memmove(rx->buff, rx->buff + taille, rx->len);
+	return taille - TAILLE_ENTETE;
 }
@@ -0,0 +1,76 @@
+/**
+ *	\file		dispatch.c
+ *	\brief		Implémentation de la table de traitement des requêtes/réponses indexée par identifiant
+ *	\author		Alexandre BREVIERE
+ *	\date		12 février 2026
+ *	\version	1.0
+ */
+#include <time.h>
+#include "../include/dispatch.h"
+
+/*
+*****************************************************************************************
+ *	\noop		I M P L E M E N T A T I O N   DES   F O N C T I O N S
+ */
+/**
+ *	\fn			static void ignorer(generic in, generic ctx, generic out)
+ *	\brief		Traitement par défaut sans traitement défini : le message est ignoré
+ *	\note		Rien n'est affiché, un pair ne peut pas inonder les journaux d'identifiants
+ *				inconnus : ils restent visibles dans le profil (cf. afficherStatsDispatch())
+ */
+static void ignorer(generic in, generic ctx, generic out) {
+}
+/**
+ *	\fn			static entreeDispatch_t *entree(dispatch_t *d, int id)
+ *	\brief		Entrée de la table associée à un identifiant
+ */
+static entreeDispatch_t *entree(dispatch_t *d, int id) {
+	return &d->table[(unsigned)id < MAX_ID_REQ ? id : MAX_ID_REQ];
+}
+
+void initDispatch(dispatch_t *d, pFctTraiter defaut) {
+	d->defaut = (defaut != NULL) ? defaut : ignorer;
+	for (int i = 0; i <= MAX_ID_REQ; i++)
+		d->table[i] = (entreeDispatch_t){d->defaut, "inconnu", 0, 0, 0};
+}
+
+void enregistrerTraitement(dispatch_t *d, int id, const char *nom, pFctTraiter traiter) {
+	entreeDispatch_t *e = entree(d, id);
+	e->traiter = traiter;
+	e->nom = nom;
+}
+
+void dispatcher(dispatch_t *d, int id, generic in, generic ctx, generic out) {
+	entreeDispatch_t *e = entree(d, id);
+	struct timespec deb, fin;
+	unsigned long long ns, max;
+
+	clock_gettime(CLOCK_MONOTONIC, &deb);
+	e->traiter(in, ctx, out);
+	clock_gettime(CLOCK_MONOTONIC, &fin);
+
+	// Profil : les traitements peuvent être appelés depuis plusieurs threads
+	ns = (fin.tv_sec - deb.tv_sec) * 1000000000ULL + fin.tv_nsec - deb.tv_nsec;
+	__atomic_fetch_add(&e->nbAppels, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&e->nsTotal, ns, __ATOMIC_RELAXED);
+	max = __atomic_load_n(&e->nsMax, __ATOMIC_RELAXED);
+	while (ns > max && !__atomic_compare_exchange_n(&e->nsMax, &max, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+const entreeDispatch_t *statsTraitement(const dispatch_t *d, int id) {
+	return &d->table[(unsigned)id < MAX_ID_REQ ? id : MAX_ID_REQ];
+}
+
+void afficherStatsDispatch(const dispatch_t *d, FILE *fp) {
+	const entreeDispatch_t *e;
+
+	fprintf(fp, "%-6s %-20s %12s %12s %12s\n", "id", "traitement", "appels", "moy (ns)", "max (ns)");
+	for (int i = 0; i <= MAX_ID_REQ; i++) {
+		e = &d->table[i];
+		if (e->nbAppels == 0) continue;
+		if (i == MAX_ID_REQ) fprintf(fp, "%-6s ", "hors");
+		else fprintf(fp, "%-6d ", i);
+		fprintf(fp, "%-20s %12lu %12llu %12llu\n", e->nom, e->nbAppels,
+			e->nsTotal / e->nbAppels, e->nsMax);
+	}
+}
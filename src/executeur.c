@@ -0,0 +1,407 @@
+/**
+ * @file executeur.c
+ * @brief Table executors: many Belote tables multiplexed on a few threads
+ * @author Raphael ALLO
+ * @date 16/02/2026
+ */
+#include <unistd.h>
+#include <errno.h>
+#include "../include/executeur.h"
+
+#define INDEX_MASK ((1u << EXEC_INDEX_BITS) - 1)   ///< Slot and executor part of a table id
+#define NEXT_GENERATION (1u << EXEC_INDEX_BITS)    ///< Added to the id of a closed table to reuse its slot
+
+// ==================== TOOLS =============================================
+
+/**
+ * @brief Stops the program on a threading error
+ */
+static void checkZero(int sts, const char *msg){
+    if (sts != 0)
+    {
+        fprintf(stderr, "erreur threading: %s\n", msg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Allocates or grows an array, stops the program if memory is exhausted
+ */
+static void *grow(void *p, size_t size){
+    if ((p = realloc(p, size)) == NULL)
+    {
+        perror("--realloc()--");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/**
+ * @brief Slot of a table in its executor
+ */
+static uint32_t slotOf(const executors_t *pool, uint32_t id){
+    return (id & INDEX_MASK) / pool->nb;
+}
+
+// ==================== TURN TIMERS =======================================
+
+static void apply(executor_t *ex, const action_t *a);
+
+/**
+ * @brief Time left before a turn deadline
+ * @return Milliseconds, 0 if the deadline has passed
+ */
+static int turnLeft(const roue_t *wheel, const minuteur_t *m){
+    int64_t left = (int64_t)(wheel->origine + m->echeance * wheel->resolution) - (int64_t)horlogeMs();
+    return left > 0 ? left : 0;
+}
+
+/**
+ * @brief Deadline of a table: plays the late player's move with the automatic player
+ * @param[in] m Turn timer of the table (ex->turns[slot])
+ * @param[in] arg Executor owning the table
+ * @details The move goes through apply() like a posted action, which re-arms the timer
+ *          for the next player and notifies the result.
+ */
+static void expireTurn(minuteur_t *m, void *arg){
+    executor_t *ex = (executor_t *)arg;
+    uint32_t slot = m - ex->turns;
+    table_t *t = &ex->tables[slot];
+    const policy_t *robot = ex->pool->autoPlayer;
+    action_t a = {.table = ex->ids[slot], .player = t->toAct, .color = NONE, .automatic = true};
+
+    switch (t->phase)
+    {
+    case PHASE_BID1:
+        a.kind = ACT_BID;
+        a.take = robot->bid1(t, a.player, &ex->rng);
+        break;
+    case PHASE_BID2:
+        a.kind = ACT_BID;
+        a.take = robot->bid2(t, a.player, &a.color, &ex->rng);
+        break;
+    case PHASE_PLAY:
+        a.kind = ACT_PLAY;
+        a.card = robot->play(t, a.player, tableLegal(t), &ex->rng);
+        break;
+    default:
+        return;
+    }
+    apply(ex, &a);
+}
+
+/**
+ * @brief Restarts the deadline of a table for the player to act
+ * @param[in,out] ex Executor owning the table
+ * @param[in] slot Slot of the table
+ * @param[in] t Table, NULL once closed
+ */
+static void restartTurn(executor_t *ex, uint32_t slot, const table_t *t){
+    int ms = 0;
+
+    if (t != NULL && (t->phase == PHASE_BID1 || t->phase == PHASE_BID2)) ms = ex->pool->bidMs;
+    else if (t != NULL && t->phase == PHASE_PLAY) ms = ex->pool->playMs;
+    if (ms > 0) armerMinuteur(&ex->wheel, &ex->turns[slot], ms, expireTurn, ex);
+    else annulerMinuteur(&ex->wheel, &ex->turns[slot]);
+}
+
+/**
+ * @brief Grows the tables of an executor
+ * @param[in,out] ex Executor
+ * @param[in] slot Slot to make room for
+ * @details The timers are chained into the wheel by address: the armed ones are
+ *          taken out before the move and re-armed with the time they had left.
+ */
+static void growTables(executor_t *ex, uint32_t slot){
+    uint32_t cap = ex->capTables ? ex->capTables : 64;
+    int *left = NULL;
+
+    while (cap <= slot) cap *= 2;
+    if (ex->wheel.nbArmes > 0)
+    {
+        left = grow(NULL, ex->capTables * sizeof(int));
+        for (uint32_t i = 0; i < ex->capTables; i++)
+        {
+            left[i] = ex->turns[i].arme ? turnLeft(&ex->wheel, &ex->turns[i]) : -1;
+            annulerMinuteur(&ex->wheel, &ex->turns[i]);
+        }
+    }
+    ex->tables = grow(ex->tables, cap * sizeof(table_t));
+    ex->ids = grow(ex->ids, cap * sizeof(uint32_t));
+    ex->turns = grow(ex->turns, cap * sizeof(minuteur_t));
+    for (uint32_t i = ex->capTables; i < cap; i++) ex->ids[i] = EXEC_NO_TABLE;
+    memset(ex->turns + ex->capTables, 0, (cap - ex->capTables) * sizeof(minuteur_t));
+    if (left != NULL)
+    {
+        for (uint32_t i = 0; i < ex->capTables; i++)
+            if (left[i] >= 0) armerMinuteur(&ex->wheel, &ex->turns[i], left[i], expireTurn, ex);
+        free(left);
+    }
+    ex->capTables = cap;
+}
+
+/**
+ * @brief Gives the slot of a closed table back to execCreateTable, under a new id
+ * @param[in,out] ex Executor owning the slot
+ * @param[in] id Id of the closed table
+ */
+static void freeSlot(executor_t *ex, uint32_t id){
+    checkZero(pthread_mutex_lock(&ex->lock), "pthread_mutex_lock");
+    if (ex->nbFree == ex->capFree)
+    {
+        ex->capFree = ex->capFree ? 2 * ex->capFree : 64;
+        ex->freeIds = grow(ex->freeIds, ex->capFree * sizeof(uint32_t));
+    }
+    ex->freeIds[ex->nbFree++] = id + NEXT_GENERATION;
+    checkZero(pthread_mutex_unlock(&ex->lock), "pthread_mutex_unlock");
+}
+
+// ==================== EXECUTOR THREAD ===================================
+
+/**
+ * @brief Applies one action to a table of the executor
+ * @param[in,out] ex Executor owning the table
+ * @param[in] a Action to apply
+ * @details Deals are not actions of a player: a table reaching PHASE_DEAL is dealt
+ *          at once, so the callback always sees a table waiting for a player.
+ *          An accepted action restarts the turn deadline of the table. An action whose
+ *          id is not the live one of its slot (table closed, slot reused since) is refused.
+ */
+static void apply(executor_t *ex, const action_t *a){
+    uint32_t slot = slotOf(ex->pool, a->table);
+    table_t *t = NULL;
+    bool accepted = false;
+
+    if (a->kind == ACT_CREATE)
+    {
+        if (slot >= ex->capTables) growTables(ex, slot);
+        tableInit(&ex->tables[slot], a->seed);
+        ex->ids[slot] = a->table;
+    }
+    if (slot < ex->capTables && ex->ids[slot] == a->table) t = &ex->tables[slot];
+    if (t != NULL)
+    {
+        switch (a->kind)
+        {
+        case ACT_CREATE: accepted = true; break;
+        case ACT_BID: accepted = tableBid(t, a->player, a->take, a->color); break;
+        case ACT_PLAY: accepted = tablePlay(t, a->player, a->card); break;
+        case ACT_CLOSE:
+            ex->ids[slot] = EXEC_NO_TABLE;
+            freeSlot(ex, a->table);
+            t = NULL;
+            accepted = true;
+            break;
+        }
+        while (t != NULL && t->phase == PHASE_DEAL) tableDeal(t);
+        if (accepted) restartTurn(ex, slot, t);
+    }
+    ex->nbActions++;
+    if (ex->pool->notify != NULL) ex->pool->notify(ex->pool->ctx, ex->num, t, a, accepted);
+}
+
+/**
+ * @brief Waits for the mailbox, at most until the next tick of the turn deadlines
+ * @param[in,out] ex Executor, locked
+ * @return false if the wait timed out
+ */
+static bool waitMail(executor_t *ex){
+    int ms = delaiRoue(&ex->wheel);
+    struct timespec ts;
+    int sts;
+
+    if (ms < 0)
+    {
+        checkZero(pthread_cond_wait(&ex->wake, &ex->lock), "pthread_cond_wait");
+        return true;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec++; ts.tv_nsec -= 1000000000L; }
+    sts = pthread_cond_timedwait(&ex->wake, &ex->lock, &ts);
+    if (sts == ETIMEDOUT) return false;
+    checkZero(sts, "pthread_cond_timedwait");
+    return true;
+}
+
+/**
+ * @brief Event loop of an executor: takes the whole mailbox, then applies it without lock
+ * @param[in,out] arg Executor (executor_t)
+ * @details The expired turn deadlines play for the late players once the mailbox is
+ *          empty: a reply posted before its deadline, even during a batch slower than
+ *          the turn limit, is applied before the deadline can fire.
+ */
+static void *run(void *arg){
+    executor_t *ex = (executor_t *)arg;
+    action_t *batch = NULL, *tmp;
+    int nb, capBatch = 0, cap;
+
+    checkZero(pthread_mutex_lock(&ex->lock), "pthread_mutex_lock");
+    while (1)
+    {
+        while (ex->nbMail == 0 && !ex->stop)
+        {
+            if (waitMail(ex)) continue;
+            // The wheel belongs to the executor: served without the mailbox lock
+            checkZero(pthread_mutex_unlock(&ex->lock), "pthread_mutex_unlock");
+            avancerRoue(&ex->wheel);
+            checkZero(pthread_mutex_lock(&ex->lock), "pthread_mutex_lock");
+        }
+        if (ex->nbMail == 0) break;
+        // The filled mailbox is swapped with the applied batch: posting never waits for the engine
+        tmp = batch; batch = ex->mailbox; ex->mailbox = tmp;
+        cap = capBatch; capBatch = ex->capMail; ex->capMail = cap;
+        nb = ex->nbMail; ex->nbMail = 0;
+        checkZero(pthread_mutex_unlock(&ex->lock), "pthread_mutex_unlock");
+
+        for (int i = 0; i < nb; i++) apply(ex, &batch[i]);
+
+        checkZero(pthread_mutex_lock(&ex->lock), "pthread_mutex_lock");
+    }
+    checkZero(pthread_mutex_unlock(&ex->lock), "pthread_mutex_unlock");
+    free(batch);
+    return NULL;
+}
+
+// ==================== POOL ==============================================
+
+/**
+ * @brief Starts the executor threads
+ * @param[out] pool Pool to start
+ * @param[in] nb Number of threads, 0 for one per core
+ * @param[in] notify Result callback (may be NULL)
+ * @param[in] ctx Context given to the callback
+ */
+void execStart(executors_t *pool, int nb, execNotify_t notify, void *ctx){
+    pthread_condattr_t attr;
+
+    if (nb <= 0) nb = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nb <= 0) nb = 1;
+    pool->nb = nb;
+    pool->nextExec = 0;
+    pool->notify = notify;
+    pool->ctx = ctx;
+    if ((pool->exec = aligned_alloc(64, nb * sizeof(executor_t))) == NULL)
+    {
+        perror("--aligned_alloc()--");
+        exit(EXIT_FAILURE);
+    }
+    memset(pool->exec, 0, nb * sizeof(executor_t));
+    pool->bidMs = pool->playMs = 0;
+    pool->autoPlayer = NULL;
+    // Turn deadlines are measured on the monotonic clock, like the wheel
+    checkZero(pthread_condattr_init(&attr), "pthread_condattr_init");
+    checkZero(pthread_condattr_setclock(&attr, CLOCK_MONOTONIC), "pthread_condattr_setclock");
+    for (int i = 0; i < nb; i++)
+    {
+        executor_t *ex = &pool->exec[i];
+        ex->num = i;
+        ex->pool = pool;
+        initRoue(&ex->wheel, TURN_RESOLUTION_MS);
+        rngSeed(&ex->rng, (uint64_t)time(NULL), i);
+        checkZero(pthread_mutex_init(&ex->lock, NULL), "pthread_mutex_init");
+        checkZero(pthread_cond_init(&ex->wake, &attr), "pthread_cond_init");
+        checkZero(pthread_create(&ex->th, NULL, run, ex), "pthread_create");
+    }
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * @brief Limits the time of each bid and card, the executor then plays for the late player
+ * @param[in,out] pool Pool of executors
+ * @param[in] bidMs Time allowed for a bid, 0 for no limit
+ * @param[in] playMs Time allowed to play a card, 0 for no limit
+ * @param[in] autoPlayer Robot deciding on timeout, NULL for "passif" (pass, cheapest card)
+ */
+void execTurnTimers(executors_t *pool, int bidMs, int playMs, const policy_t *autoPlayer){
+    pool->autoPlayer = autoPlayer != NULL ? autoPlayer : findPolicy("passif");
+    // Read by the executors once the first table is posted: the mailbox lock orders it
+    pool->bidMs = bidMs > 0 ? bidMs : 0;
+    pool->playMs = playMs > 0 ? playMs : 0;
+}
+
+/**
+ * @brief Queues an action in the mailbox of an executor
+ * @param[in,out] ex Executor, locked
+ * @param[in] a Action, copied
+ */
+static void postLocked(executor_t *ex, const action_t *a){
+    if (ex->nbMail == ex->capMail)
+    {
+        ex->capMail = ex->capMail ? 2 * ex->capMail : 256;
+        ex->mailbox = grow(ex->mailbox, ex->capMail * sizeof(action_t));
+    }
+    ex->mailbox[ex->nbMail++] = *a;
+    // Only an empty mailbox can have its executor asleep
+    if (ex->nbMail == 1) checkZero(pthread_cond_signal(&ex->wake), "pthread_cond_signal");
+}
+
+/**
+ * @brief Creates a table on the next executor, in a closed slot if it has one
+ * @param[in,out] pool Pool of executors
+ * @param[in] seed Seed of the table (see tableInit)
+ * @return Id of the table, usable at once: the creation is queued before any other action
+ */
+uint32_t execCreateTable(executors_t *pool, uint64_t seed){
+    executor_t *ex = &pool->exec[__atomic_fetch_add(&pool->nextExec, 1, __ATOMIC_RELAXED) % pool->nb];
+    action_t a = {.kind = ACT_CREATE, .seed = seed};
+
+    checkZero(pthread_mutex_lock(&ex->lock), "pthread_mutex_lock");
+    if (ex->nbFree > 0) a.table = ex->freeIds[--ex->nbFree];
+    else
+    {
+        // The last index is kept out so that no id equals EXEC_NO_TABLE
+        if ((uint64_t)ex->nbSlots * pool->nb + ex->num >= INDEX_MASK)
+        {
+            fprintf(stderr, "--execCreateTable()-- : plus de %u tables ouvertes\n", INDEX_MASK);
+            exit(EXIT_FAILURE);
+        }
+        a.table = ex->nbSlots++ * pool->nb + ex->num;
+    }
+    postLocked(ex, &a);
+    checkZero(pthread_mutex_unlock(&ex->lock), "pthread_mutex_unlock");
+    return a.table;
+}
+
+/**
+ * @brief Posts an action to the executor of its table
+ * @param[in,out] pool Pool of executors
+ * @param[in] a Action, copied
+ */
+void execPost(executors_t *pool, const action_t *a){
+    executor_t *ex = &pool->exec[(a->table & INDEX_MASK) % pool->nb];
+
+    checkZero(pthread_mutex_lock(&ex->lock), "pthread_mutex_lock");
+    postLocked(ex, a);
+    checkZero(pthread_mutex_unlock(&ex->lock), "pthread_mutex_unlock");
+}
+
+/**
+ * @brief Stops the executors once their mailboxes are empty and waits for them
+ * @param[in,out] pool Pool of executors
+ */
+void execStop(executors_t *pool){
+    for (int i = 0; i < pool->nb; i++)
+    {
+        executor_t *ex = &pool->exec[i];
+        checkZero(pthread_mutex_lock(&ex->lock), "pthread_mutex_lock");
+        ex->stop = true;
+        checkZero(pthread_cond_signal(&ex->wake), "pthread_cond_signal");
+        checkZero(pthread_mutex_unlock(&ex->lock), "pthread_mutex_unlock");
+    }
+    for (int i = 0; i < pool->nb; i++)
+    {
+        executor_t *ex = &pool->exec[i];
+        checkZero(pthread_join(ex->th, NULL), "pthread_join");
+        free(ex->mailbox);
+        free(ex->tables);
+        free(ex->ids);
+        free(ex->turns);
+        free(ex->freeIds);
+        pthread_mutex_destroy(&ex->lock);
+        pthread_cond_destroy(&ex->wake);
+    }
+    free(pool->exec);
+    pool->exec = NULL;
+}
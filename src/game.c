@@ -77,6 +77,7 @@ void serveur (char *adrIP, int port) {
  */
 int main(int argc, char** argv) {
 	progName = argv[0];
+	initTraitements();
 #ifdef CLIENT
 	if (argc<3) {
 		fprintf(stderr,"usage : %s @IP port\n", basename(progName));
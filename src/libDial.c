@@ -2,26 +2,14 @@
 
 void DialC(socket_t sd) {
     requete_t req; 
-    reponse_t rep;
+    reponse_t rep = {0};
     int nbOctets;
 
     while(1) {
-        recevoir(&sd, (generic)&req, (pFct)str2req);
+        recevoir(&sd, (generic)&req, (pFctDeSerial)str2req);
 
-        switch (req.idReq) {
-            case 101:
-                traiterReq101(&req);
-                break;
-            case 102:
-                traiterReq102(&req);
-                break;
-            case 103:
-                traiterReq103(&req);
-                break;
-            default:
-                printf("Requête inconnue : %d\n", req.idReq);
-                break;
-        }
+        // traitements enregistrés par initTraitements()
+        traiterDial(&req, &sd);
 
         rep.idRep = 201;
         strcpy(rep.verbRep, "Verb");
@@ -36,7 +24,7 @@ void DialC(socket_t sd) {
 void DialSrv(socket_t sockEcoute){
 	socket_t sa;		// socket de dialogue avec un client
 	reponse_t rep;
-	requete_t req;
+	requete_t req = {0};
 	// sockEcoute est une variable externe
 	while(1){
 		req.idReq = 101;
@@ -47,7 +35,7 @@ void DialSrv(socket_t sockEcoute){
 		//mise en forme
 		//si fin dialogue alors break
 		envoyer(&sa,(generic)&req,(pFct)req2str);
-		recevoir(&sa,(generic)&rep,(pFct)str2rep);
+		recevoir(&sa,(generic)&rep,(pFctDeSerial)str2rep);
 		traiterRep(&rep);
 	}
 		CHECK(close(sa.fd),"-- PB close() --");
@@ -55,7 +43,7 @@ void DialSrv(socket_t sockEcoute){
 }
 
 void DialRegister(socket_t sd) {
-    requete_t req; 
+    requete_t req = {0};
     reponse_t rep;
     int nbOctets;
 
@@ -65,7 +53,7 @@ void DialRegister(socket_t sd) {
         strcpy(req.verbReq, "Verb");
 		strcpy(req.optReq, "Opt");
         envoyer(&sd,(generic)&req,(pFct)req2str);
-		recevoir(&sd,(generic)&rep,(pFct)str2rep);
+		recevoir(&sd,(generic)&rep,(pFctDeSerial)str2rep);
 		traiterRep(&rep);
     }
 
@@ -1,50 +1,280 @@
 #include "../include/libRepReq.h"
 
-void req2str(const requete_t * req, char* str){
+// codecs négociables, indexés par socket_t.codec
+static const codec_t codecs[] = {
+	[CODEC_TEXTE]   = {(pFct)req2str, (pFctDeSerial)str2req, (pFct)rep2str, (pFctDeSerial)str2rep},
+	[CODEC_BINAIRE] = {(pFct)req2bin, (pFctDeSerial)bin2req, (pFct)rep2bin, (pFctDeSerial)bin2rep}
+};
+
+// option typée rendue en texte pour le codec texte
+static const char * optTexte(char typeOpt, const optBin_t * optBin, const char * opt, char * tmp){
+	switch(typeOpt){
+		case OPT_CARTES: sprintf(tmp, "%u", optBin->cartes); return tmp;
+		case OPT_JOUEUR: sprintf(tmp, "%u", optBin->joueur); return tmp;
+		case OPT_SCORES: sprintf(tmp, "%d/%d", optBin->scores.eq1, optBin->scores.eq2); return tmp;
+		default: return opt;
+	}
+}
+
+int req2str(const requete_t * req, char* str){
+	char tmp[32];
+	int lg;
 	//CHECK
-	sprintf(str,REQ_STR_OUT,req->idReq,req->verbReq,req->optReq);
+	lg = sprintf(str,REQ_STR_OUT,req->idReq,req->verbReq,optTexte(req->typeOpt,&req->optBin,req->optReq,tmp));
 	#ifdef DEBUG
 		fprintf(stderr,"requete recu");
 		fprintf(stderr,REQ_STR_OUT"\n",req->idReq,req->verbReq,req->optReq);
 	#endif
+	return lg+1;
 }
 
-void str2req(const char* str, requete_t  * req){
-	//CHECK
-	sscanf(str,REQ_STR_IN,&req->idReq,req->verbReq,req->optReq);
+// "id:verbe:option" pris dans les lg octets reçus (trame pas forcément terminée par \0)
+static int str2mess(const char * str, int lg, short * id, char * verb, int maxVerb, char * opt, int maxOpt){
+	char tmp[MAX_BUFFER+1], * verbe, * option;
+	int n = 0, lgVerbe, lgOption;
+
+	if(lg < 0) lg = 0;
+	if(lg > MAX_BUFFER) lg = MAX_BUFFER;
+	memcpy(tmp, str, lg);
+	tmp[lg] = '\0';
+	if(sscanf(tmp, "%hi:%n", id, &n) != 1 || n == 0) return -1;
+	verbe = tmp + n;
+	if((option = strchr(verbe, ':')) == NULL) return -1;
+	lgVerbe = option++ - verbe;
+	lgOption = strcspn(option, "\n");
+	if(lgVerbe >= maxVerb || lgOption >= maxOpt) return -1;
+	memcpy(verb, verbe, lgVerbe);
+	verb[lgVerbe] = '\0';
+	memcpy(opt, option, lgOption);
+	opt[lgOption] = '\0';
+	return 0;
+}
+
+int str2req(const char* str, int lg, requete_t  * req){
+	if(str2mess(str, lg, &req->idReq, req->verbReq, sizeof(req->verbReq), req->optReq, sizeof(req->optReq)) == -1){
+		req->idReq = -1;
+		req->verbReq[0] = req->optReq[0] = '\0';
+	}
+	req->typeOpt = OPT_TEXTE;
 	#ifdef DEBUG
 		fprintf(stderr,"requete recu");
 		fprintf(stderr,REQ_STR_OUT"\n",req->idReq,req->verbReq,req->optReq);
 	#endif
+	return 0;
 }
 
-void rep2str(const reponse_t * rep, char* str){
+int rep2str(const reponse_t * rep, char* str){
+	char tmp[32];
+	int lg;
 	//CHECK
-	sprintf(str,REP_STR_OUT,rep->idRep,rep->verbRep,rep->optRep);
+	lg = sprintf(str,REP_STR_OUT,rep->idRep,rep->verbRep,optTexte(rep->typeOpt,&rep->optBin,rep->optRep,tmp));
 	#ifdef DEBUG
 		fprintf(stderr,"reponse recu");
 		fprintf(stderr,REQ_STR_OUT"\n",rep->idRep,rep->verbRep,rep->optRep);
 	#endif
+	return lg+1;
 }
 
-void str2rep(const char* str, reponse_t  * rep){
-	//CHECK
-	sscanf(str,REP_STR_IN,&rep->idRep,rep->verbRep,rep->optRep);
+int str2rep(const char* str, int lg, reponse_t  * rep){
+	if(str2mess(str, lg, &rep->idRep, rep->verbRep, sizeof(rep->verbRep), rep->optRep, sizeof(rep->optRep)) == -1){
+		rep->idRep = -1;
+		rep->verbRep[0] = rep->optRep[0] = '\0';
+	}
+	rep->typeOpt = OPT_TEXTE;
 	#ifdef DEBUG
 		fprintf(stderr,"reponse recu");
 		fprintf(stderr,REQ_STR_OUT"\n",rep->idRep,rep->verbRep,rep->optRep);
 	#endif
+	return 0;
+}
+
+/*
+ * Codec binaire (petit-boutiste) :
+ *	version:1 | longueur totale:2 | id:2 | typeOpt:1 | lgVerbe:1 | verbe | option
+ * option selon typeOpt : OPT_TEXTE lg:1 + octets, OPT_CARTES 4, OPT_JOUEUR 1, OPT_SCORES 4+4
+ */
+static char * ecrire16(char * p, uint16_t v){ p[0]=v; p[1]=v>>8; return p+2; }
+static char * ecrire32(char * p, uint32_t v){ p[0]=v; p[1]=v>>8; p[2]=v>>16; p[3]=v>>24; return p+4; }
+static uint16_t lire16(const char * p){
+	const unsigned char * o = (const unsigned char *)p;
+	return o[0] | (o[1]<<8);
+}
+static uint32_t lire32(const char * p){
+	const unsigned char * o = (const unsigned char *)p;
+	return o[0] | (o[1]<<8) | (o[2]<<16) | ((uint32_t)o[3]<<24);
+}
+static char * ecrireChaine(char * p, const char * str, int max){
+	int lg = strnlen(str, max-1);
+	*p++ = lg;
+	memcpy(p, str, lg);
+	return p+lg;
+}
+// NULL si la chaîne dépasse la fin du message ou la taille du champ (ecrireChaine() la tronque)
+static const char * lireChaine(const char * p, const char * fin, char * str, int max){
+	int lg;
+	if(p >= fin) return NULL;
+	lg = (unsigned char)*p++;
+	if(lg > fin-p || lg > max-1) return NULL;
+	memcpy(str, p, lg);
+	str[lg] = '\0';
+	return p+lg;
+}
+
+static int mess2bin(short id, const char * verb, int maxVerb, const char * opt, int maxOpt,
+		char typeOpt, const optBin_t * optBin, char * buf){
+	char * p = buf+3;
+	p = ecrire16(p, id);
+	*p++ = typeOpt;
+	p = ecrireChaine(p, verb, maxVerb);
+	switch(typeOpt){
+		case OPT_CARTES: p = ecrire32(p, optBin->cartes); break;
+		case OPT_JOUEUR: *p++ = optBin->joueur; break;
+		case OPT_SCORES: p = ecrire32(p, optBin->scores.eq1); p = ecrire32(p, optBin->scores.eq2); break;
+		default: p = ecrireChaine(p, opt, maxOpt); break;
+	}
+	buf[0] = BIN_VERSION;
+	ecrire16(buf+1, p-buf);
+	return p-buf;
+}
+
+// -1 si le message est incohérent : chaque champ doit tenir dans les lg octets reçus,
+// la longueur annoncée valoir lg et les champs la couvrir exactement
+static int bin2mess(const char * buf, int lg, short * id, char * verb, int maxVerb, char * opt, int maxOpt,
+		char * typeOpt, optBin_t * optBin){
+	const char * p = buf+6, * fin = buf+lg;
+	if(lg < 6 || (unsigned char)buf[0] != BIN_VERSION || lire16(buf+1) != lg) return -1;
+	*id = (short)lire16(buf+3);
+	*typeOpt = buf[5];
+	if((p = lireChaine(p, fin, verb, maxVerb)) == NULL) return -1;
+	opt[0] = '\0';
+	switch(*typeOpt){
+		case OPT_CARTES: if(fin-p != 4) return -1; optBin->cartes = lire32(p); break;
+		case OPT_JOUEUR: if(fin-p != 1) return -1; optBin->joueur = *p; break;
+		case OPT_SCORES: if(fin-p != 8) return -1; optBin->scores.eq1 = lire32(p); optBin->scores.eq2 = lire32(p+4); break;
+		case OPT_TEXTE: if(lireChaine(p, fin, opt, maxOpt) != fin) return -1; break;
+		default: return -1;
+	}
+	return 0;
+}
+
+int req2bin(const requete_t * req, char * buf){
+	return mess2bin(req->idReq, req->verbReq, sizeof(req->verbReq), req->optReq, sizeof(req->optReq),
+		req->typeOpt, &req->optBin, buf);
+}
+
+int bin2req(const char * buf, int lg, requete_t * req){
+	// message texte reçu avant la fin de la négociation
+	if(lg <= 0 || !(buf[0] & MESS_BIN)) return str2req(buf, lg, req);
+	if(bin2mess(buf, lg, &req->idReq, req->verbReq, sizeof(req->verbReq), req->optReq, sizeof(req->optReq),
+			&req->typeOpt, &req->optBin) == -1){
+		req->idReq = -1;
+		fprintf(stderr,"message binaire invalide : version %#x, %d octets\n",(unsigned char)buf[0],lg);
+	}
+	return 0;
+}
+
+int rep2bin(const reponse_t * rep, char * buf){
+	return mess2bin(rep->idRep, rep->verbRep, sizeof(rep->verbRep), rep->optRep, sizeof(rep->optRep),
+		rep->typeOpt, &rep->optBin, buf);
+}
+
+int bin2rep(const char * buf, int lg, reponse_t * rep){
+	// message texte reçu avant la fin de la négociation
+	if(lg <= 0 || !(buf[0] & MESS_BIN)) return str2rep(buf, lg, rep);
+	if(bin2mess(buf, lg, &rep->idRep, rep->verbRep, sizeof(rep->verbRep), rep->optRep, sizeof(rep->optRep),
+			&rep->typeOpt, &rep->optBin) == -1){
+		rep->idRep = -1;
+		fprintf(stderr,"message binaire invalide : version %#x, %d octets\n",(unsigned char)buf[0],lg);
+	}
+	return 0;
+}
+
+const codec_t * codecSocket(const socket_t * sockEch){
+	return &codecs[sockEch->codec];
+}
+
+int proposerCodec(socket_t * sockEch, int codec){
+	requete_t req = {REQ_CODEC, "CODEC", NOM_CODEC_BINAIRE};
+	reponse_t rep;
+
+	if(codec != CODEC_BINAIRE || sockEch->codec == CODEC_BINAIRE) return sockEch->codec;
+	envoyer(sockEch, (generic)&req, codecSocket(sockEch)->req2buf);
+	recevoirRep(sockEch, &rep);
+	// le binaire nécessite des trames délimitées par leur longueur
+	if(rep.idRep == 401 && sockEch->mode == SOCK_STREAM){
+		modeTrame(sockEch, TRAME_LONGUEUR);
+		sockEch->codec = CODEC_BINAIRE;
+	}
+	return sockEch->codec;
+}
+
+void accepterCodec(socket_t * sockEch, const char * nomCodec){
+	requete_t req = {402, "CODEC", ""};
+
+	strncpy(req.optReq, nomCodec, sizeof(req.optReq)-1);
+	if(strcmp(nomCodec, NOM_CODEC_BINAIRE) == 0 && sockEch->mode == SOCK_STREAM) req.idReq = 401;
+	// la réponse part encore avec le codec courant (côté serveur : une erreur marque la socket morte)
+	if(envoyerSts(sockEch, (generic)&req, codecSocket(sockEch)->req2buf) == -1) return;
+	if(req.idReq == 401){
+		modeTrame(sockEch, TRAME_LONGUEUR);
+		sockEch->codec = CODEC_BINAIRE;
+	}
+}
+
+int repondreSonde(socket_t * sockEch, short id){
+	reponse_t rep = {REQ_SONDE, "SONDE", ""};
+
+	if(id != REQ_SONDE) return 0;
+	envoyerSts(sockEch, (generic)&rep, codecSocket(sockEch)->rep2buf);
+	return 1;
+}
+
+void recevoirReq(socket_t * sockEch, requete_t * req){
+	do recevoir(sockEch, (generic)req, codecSocket(sockEch)->buf2req);
+	while(repondreSonde(sockEch, req->idReq));
+}
+
+void recevoirRep(socket_t * sockEch, reponse_t * rep){
+	do recevoir(sockEch, (generic)rep, codecSocket(sockEch)->buf2rep);
+	while(repondreSonde(sockEch, rep->idRep));
+}
+
+void sonderClient(socket_t * sockEch){
+	requete_t req = {REQ_SONDE, "SONDE", ""};
+
+	envoyerSts(sockEch, (generic)&req, codecSocket(sockEch)->req2buf);
 }
 
-void traiterReq101(requete_t * req){
+int diffuserReq(socket_t * socks[], int nb, const requete_t * req){
+	socket_t * parCodec[nb];
+	diffusion_t * diff;
+	int nbServies = 0, n;
+
+	for(int codec = CODEC_TEXTE; codec <= CODEC_BINAIRE; codec++){
+		n = 0;
+		for(int i = 0; i < nb; i++)
+			if(socks[i] != NULL && socks[i]->codec == codec) parCodec[n++] = socks[i];
+		if(n == 0) continue;
+		// un seul tampon partagé par tous les destinataires de ce codec
+		diff = creerDiffusion((generic)req, codecs[codec].req2buf);
+		nbServies += diffuser(diff, parCodec, n);
+		rendreDiffusion(diff);
+	}
+	return nbServies;
+}
+
+void traiterReq101(generic in, generic ctx, generic out){
+	requete_t * req = in;
 	fprintf(stderr,REQ_STR_OUT"\n",req->idReq,req->verbReq,req->optReq);
 }
 
-void traiterReq102(requete_t * req){
+void traiterReq102(generic in, generic ctx, generic out){
+	requete_t * req = in;
 	fprintf(stderr,REQ_STR_OUT"\n",req->idReq,req->verbReq,req->optReq);
 }
 
-void traiterReq103(requete_t * req){
+void traiterReq103(generic in, generic ctx, generic out){
+	requete_t * req = in;
 	fprintf(stderr,REQ_STR_OUT"\n",req->idReq,req->verbReq,req->optReq);
 }
 
@@ -52,51 +282,127 @@ void traiterRep(reponse_t * rep){
 		fprintf(stderr,REQ_STR_OUT"\n",rep->idRep,rep->verbRep,rep->optRep);
 }
 
-requete_t traiterRegister(reponse_t * rep, socket_t * sDial){
+// traitements du dialogue (DialC) et du serveur d'enregistrement (traiterRegister)
+static dispatch_t traitementsDial, traitementsRegister;
+
+// les demandes 302 à 305 nécessitent une socket identifiée par 300/301
+static int userIdentifie(socket_t * sDial, requete_t * req){
+	int index = userSocket(sDial);
+	if(index == -1){
+		req->idReq = 402;
+		strcpy(req->optReq, "Utilisateur non identifié");
+	}
+	return index;
+}
+
+// in : demande reçue (reponse_t), ctx : socket du client, out : requête à renvoyer
+static void traiterRegister300(generic in, generic ctx, generic out){
+	reponse_t * rep = in;
+	requete_t * req = out;
+	if(enregistrerUser(rep->optRep, ctx)==-1) req->idReq = 402;
+	else req->idReq = 401;
+}
+
+static void traiterRegister301(generic in, generic ctx, generic out){
+	reponse_t * rep = in;
+	requete_t * req = out;
+	if(trouverUser(rep->optRep)==-1) req->idReq = 3;
+	else if(enregistrerUser(rep->optRep, ctx)==-1){
+		req->idReq = 402;
+		strcpy(req->optReq, "Utilisateur déjà connecté");
+	}
+	else req->idReq = 401;
+}
+
+static void traiterRegister302(generic in, generic ctx, generic out){
+	int index;
+	if((index=userIdentifie(ctx, out))==-1) return;
+	// pas de réponse : la socket est fermée
+	deconnecterUser(index);
+}
+
+static void traiterRegister303(generic in, generic ctx, generic out){
+	requete_t * req = out;
 	int index;
-	requete_t req;
-	switch(rep->idRep){
-		case 301:
-			index=trouverUser( rep->optRep);
-			if(index==-1)req.idReq = 3;
-			else req.idReq = 401;
-			break;
-
-		case 302:
-			deconnecterUser(identifierUser(sDial));
-			break;
-
-		case 303:
-			creerPartie(sDial); //TODO => Faire la fonction créer partie
-			req.idReq=401;
-			break;
-
-		case 304:
-			if(isFull(rep->optRep)){ //TODO => Faire la fonction isFull
-				req.idReq=2;
-			}
-			else{
-				modifierDest(identifierUser(sDial), rep->optRep);
-				req.idReq = 401;
-			}
-			break;
-
-		case 305:
-			for(int i = 0; i < MAX_USERS; i++){
-				if(!isFull(i)){
-					modifierDest(identifierUser(sDial),i );
-					req.idReq=401;
-					break;
-					req.idReq=402;
-					strcpy(req.optReq, "join aléatoire");
-				}
-			}
-			break;
-
-		default:
-			req.idReq = 402;
-			strcpy(req.optReq, "Demande inconnue");
-			break;
+	if((index=userIdentifie(ctx, req))==-1) return;
+	if(creerPartie(index).index==-1){
+		req->idReq=402;
+		strcpy(req->optReq, "Trop de parties");
 	}
+	else req->idReq=401;
+}
+
+static void traiterRegister304(generic in, generic ctx, generic out){
+	reponse_t * rep = in;
+	requete_t * req = out;
+	int index;
+	if((index=userIdentifie(ctx, req))==-1) return;
+	// partie de l'utilisateur nommé : inexistante ou complète => refus
+	if(rejoindrePartie(index, partieUser(trouverUser(rep->optRep)))==-1){
+		req->idReq=2;
+	}
+	else{
+		modifierDest(index, rep->optRep);
+		req->idReq = 401;
+	}
+}
+
+static void traiterRegister305(generic in, generic ctx, generic out){
+	requete_t * req = out;
+	int index;
+	hPartie_t partie;
+	if((index=userIdentifie(ctx, req))==-1) return;
+	// partie la plus proche d'être complète, sans parcourir les utilisateurs
+	if((partie=rejoindrePartieAlea(index)).index==-1){
+		req->idReq=402;
+		strcpy(req->optReq, "join aléatoire");
+		return;
+	}
+	modifierDest(index, nameUser(hotePartie(partie)));
+	req->idReq=401;
+}
+
+static void traiterSonde(generic in, generic ctx, generic out){
+	// réponse à sonderClient() : sa réception a suffi à prouver que le client est vivant
+}
+
+static void traiterCodec(generic in, generic ctx, generic out){
+	reponse_t * rep = in;
+	// accepterCodec() répond avant de changer de codec : rien de plus à émettre
+	accepterCodec(ctx, rep->optRep);
+}
+
+// identifiant inconnu : refusé sans trace, le profil du dispatch les compte
+static void traiterDefaut(generic in, generic ctx, generic out){
+	requete_t * req = out;
+	req->idReq = 402;
+	strcpy(req->optReq, "Demande inconnue");
+}
+
+void initTraitements(void){
+	// dialogue (DialC) : identifiants inconnus ignorés
+	initDispatch(&traitementsDial, NULL);
+	enregistrerTraitement(&traitementsDial, 101, "traiterReq101", traiterReq101);
+	enregistrerTraitement(&traitementsDial, 102, "traiterReq102", traiterReq102);
+	enregistrerTraitement(&traitementsDial, 103, "traiterReq103", traiterReq103);
+	// serveur d'enregistrement (traiterRegister)
+	initDispatch(&traitementsRegister, traiterDefaut);
+	enregistrerTraitement(&traitementsRegister, 300, "identifier", traiterRegister300);
+	enregistrerTraitement(&traitementsRegister, 301, "connexion", traiterRegister301);
+	enregistrerTraitement(&traitementsRegister, 302, "deconnexion", traiterRegister302);
+	enregistrerTraitement(&traitementsRegister, 303, "creerPartie", traiterRegister303);
+	enregistrerTraitement(&traitementsRegister, 304, "rejoindre", traiterRegister304);
+	enregistrerTraitement(&traitementsRegister, 305, "rejoindreAlea", traiterRegister305);
+	enregistrerTraitement(&traitementsRegister, REQ_CODEC, "codec", traiterCodec);
+	enregistrerTraitement(&traitementsRegister, REQ_SONDE, "sonde", traiterSonde);
+}
+
+void traiterDial(requete_t * req, socket_t * sDial){
+	dispatcher(&traitementsDial, req->idReq, req, sDial, NULL);
+}
+
+requete_t traiterRegister(reponse_t * rep, socket_t * sDial){
+	requete_t req = {0};
+	dispatcher(&traitementsRegister, rep->idRep, rep, sDial, &req);
 	return req;
-}
\ No newline at end of file
+}
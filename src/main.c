@@ -10,11 +10,13 @@ int main () {
     char nomUtilisateur[50];
     int choix;
     socket_t sdSE;
-    requete_t req;
+    requete_t req = {0};
     reponse_t rep;
 
     // initialisation de la connexion au serveur d'enregistrement
     sdSE = connecterClt2Srv(IP_SERVEUR_ENREGISTREMENT, PORT_SERVEUR_ENREGISTREMENT);
+    // codec binaire si le serveur l'accepte, texte sinon
+    proposerCodec(&sdSE, CODEC_BINAIRE);
 
     // Connexion au Serveur d'Enregistrement
     while(connexionToSE(&sdSE, nomUtilisateur) != 0);
@@ -28,7 +30,7 @@ int main () {
             req.idReq = 303;
             strcpy(req.verbReq, "CreerPartie");
             strcpy(req.optReq, nomUtilisateur);
-            envoyer(&sdSE, (generic)&req, (pFct) req2str);
+            envoyer(&sdSE, (generic)&req, codecSocket(&sdSE)->req2buf);
             break;
         case 2:
             printf("Rejoindre la partie d'un utilisateur\n");
@@ -65,7 +67,7 @@ int choisir () {
 
 int connexionToSE (socket_t *sdSE, char * nomUtilisateur) {
 
-    requete_t reqConnexion;
+    requete_t reqConnexion = {0};
     reponse_t repServeurE;
 
     printf("Bienvenue sur Rebelotte !\n");
@@ -78,10 +80,10 @@ int connexionToSE (socket_t *sdSE, char * nomUtilisateur) {
     strcpy(reqConnexion.optReq, nomUtilisateur);
 
     // envoie de la requête
-    envoyer(sdSE, (generic)&reqConnexion, (pFct) req2str);
+    envoyer(sdSE, (generic)&reqConnexion, codecSocket(sdSE)->req2buf);
 
-    // traitement de la réponse du serveur
-    recevoir(sdSE, (generic)&repServeurE, (pFct) str2rep);
+    // traitement de la réponse du serveur (une sonde reçue entre-temps est répondue)
+    recevoirRep(sdSE, &repServeurE);
 
     if (repServeurE.idRep == 401) {
         printf("Connexion reussie ! Bienvenue %s\n", nomUtilisateur);
@@ -0,0 +1,99 @@
+/**
+ *	\file		minuterie.c
+ *	\brief		Implémentation de la roue de minuteurs
+ *	\author		Alexandre BREVIERE
+ *	\date		17 février 2026
+ *	\version	1.0
+ */
+#include <string.h>
+#include <time.h>
+#include "../include/minuterie.h"
+/*
+*****************************************************************************************
+ *	\noop		I M P L E M E N T A T I O N   DES   F O N C T I O N S
+ */
+uint64_t horlogeMs(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+	return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+/**
+ *	\fn			static uint64_t tickCourant(const roue_t *r)
+ *	\brief		Tick correspondant à l'instant présent
+ */
+static uint64_t tickCourant(const roue_t *r) {
+	return (horlogeMs() - r->origine) / r->resolution;
+}
+/**
+ *	\fn			static void decrocher(roue_t *r, minuteur_t *m)
+ *	\brief		Retire un minuteur armé de sa case
+ */
+static void decrocher(roue_t *r, minuteur_t *m) {
+	if (m->prec != NULL) m->prec->suiv = m->suiv;
+	else r->cases[m->echeance & (NB_CASES_ROUE - 1)] = m->suiv;
+	if (m->suiv != NULL) m->suiv->prec = m->prec;
+	m->arme = 0;
+	r->nbArmes--;
+}
+void initRoue(roue_t *r, int resolutionMs) {
+	memset(r->cases, 0, sizeof(r->cases));
+	r->resolution = resolutionMs > 0 ? resolutionMs : 1;
+	r->origine = horlogeMs();
+	r->tick = 0;
+	r->nbArmes = 0;
+}
+void armerMinuteur(roue_t *r, minuteur_t *m, int delaiMs, pFctMinuteur action, void *arg) {
+	minuteur_t **tete;
+	uint64_t ecoule = horlogeMs() - r->origine, courant = ecoule / r->resolution;
+
+	if (m->arme) decrocher(r, m);
+	// Premier tick commençant au moins delaiMs après l'instant présent (et non après le
+	// début du tick courant, qui ferait expirer jusqu'à une résolution trop tôt)
+	m->echeance = (ecoule + (delaiMs > 0 ? delaiMs : 0) + r->resolution - 1) / r->resolution;
+	// Au moins le tick suivant : une action qui se réarme ne boucle pas dans avancerRoue()
+	if (m->echeance <= courant) m->echeance = courant + 1;
+	if (m->echeance <= r->tick) m->echeance = r->tick + 1;
+	m->action = action;
+	m->arg = arg;
+	tete = &r->cases[m->echeance & (NB_CASES_ROUE - 1)];
+	m->prec = NULL;
+	m->suiv = *tete;
+	if (*tete != NULL) (*tete)->prec = m;
+	*tete = m;
+	m->arme = 1;
+	r->nbArmes++;
+}
+void annulerMinuteur(roue_t *r, minuteur_t *m) {
+	if (m->arme) decrocher(r, m);
+}
+int avancerRoue(roue_t *r) {
+	uint64_t maintenant = tickCourant(r), t;
+	minuteur_t *m;
+	int nb = 0;
+
+	// Après une longue attente, un seul tour de roue suffit à voir toutes les cases
+	for (t = r->tick + 1; t <= maintenant && t <= r->tick + NB_CASES_ROUE; t++) {
+		// Reprise en tête après chaque action : elle a pu armer ou annuler d'autres minuteurs
+		m = r->cases[t & (NB_CASES_ROUE - 1)];
+		while (m != NULL) {
+			if (m->echeance > maintenant) {	// tour suivant de la roue
+				m = m->suiv;
+				continue;
+			}
+			decrocher(r, m);
+			m->action(m, m->arg);
+			nb++;
+			m = r->cases[t & (NB_CASES_ROUE - 1)];
+		}
+	}
+	r->tick = maintenant;
+	return nb;
+}
+int delaiRoue(const roue_t *r) {
+	int64_t delai;
+
+	if (r->nbArmes == 0) return -1;
+	delai = (int64_t)(r->origine + (r->tick + 1) * r->resolution) - (int64_t)horlogeMs();
+	return delai > 0 ? delai : 0;
+}
@@ -7,35 +7,39 @@
  * @date 02/02/2026
  */
 #include "../include/moteur.h"
+#include "../include/coroutine.h"
 
 // ==================== COMMUNICATION =====================================================
 
+/**
+ * @brief Suspends the table's coroutine until the reply of the player is filled in
+ * @param[in,out] p Prompt sent to the driver of the coroutine, holding the reply on return
+ * @details The prompt lives on the stack of the coroutine: it stays valid while the
+ *          coroutine is suspended, the driver writes the reply into it before coResume.
+ */
+static void waitReply(prompt_t *p){
+    coYield(p);
+}
+
 /**
  * @brief Adds a new player to the game
- * @param[in,out] players Array of player pointers
+ * @param[in,out] players Array of players
  * @param[in,out] nbPlayer Current number of players, incremented if successful
- * @return true if player was added successfully, false if game is full or allocation failed
+ * @return true if player was added successfully, false if game is full
  */
 bool addPlayer(players_t players, int *nbPlayer){
     if (*nbPlayer>=4){return false;}
 
-    players[*nbPlayer] = (player_t*) malloc(sizeof(player_t));
-    if (&players[*nbPlayer] == NULL) {
-        return false;
-    }
-    players[*nbPlayer]->num=*nbPlayer;
-    players[*nbPlayer]->s = FINISH;
-    for (int i = 0; i < NB_CARD_HAND; i++)
-    {
-        players[*nbPlayer]->cards[i]=NOTHING;
-    }
+    players[*nbPlayer].num=*nbPlayer;
+    players[*nbPlayer].s = FINISH;
+    players[*nbPlayer].cards = 0;
     (*nbPlayer)++;
     return true;
 }
 
 /**
  * @brief Confirms to the player that their card is valid
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player to notify
  * @todo Implement network communication to send confirmation
  */
@@ -46,7 +50,7 @@ void okCard(players_t players, int player){
 
 /**
  * @brief Sends all cards in hand to the player
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player to send cards to
  * @todo Implement network communication to send cards
  */
@@ -56,11 +60,12 @@ void giveCard(players_t players, int player){
 
 /**
  * @brief Sends the current trick to all players for display
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] pli Current trick (4 cards)
  * @todo Implement network communication to broadcast trick
  */
 void givePli(players_t players, pli_t pli){
+    if (coSelf() != NULL) return;   // remote players: no console display
     afficherPli(pli);
     afficherPlayers(players);
     return;
@@ -68,12 +73,18 @@ void givePli(players_t players, pli_t pli){
 
 /**
  * @brief Asks a player if they want to take the revealed trump card (first round)
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player being asked
  * @return true if player accepts, false otherwise
  * @todo Implement network communication for remote players
  */
 bool askTakeAtout(players_t players, int player){
+    if (coSelf() != NULL)
+    {
+        prompt_t p = {.kind = PROMPT_BID1, .player = player, .take = false};
+        waitReply(&p);
+        return p.take;
+    }
     // if(player == 0){CLient INTERNE}
     printf("Tu prend l'atout T1 ? \n");
     printf("yes=1,no=0 :");
@@ -85,7 +96,7 @@ bool askTakeAtout(players_t players, int player){
 
 /**
  * @brief Asks a player if they want to choose trump (second round) and which suit
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player being asked
  * @param[out] c Chosen trump suit (if player accepts)
  * @return true if player accepts and chooses a suit, false otherwise
@@ -94,6 +105,14 @@ bool askTakeAtout(players_t players, int player){
 bool askTakeAtoutTurn2(players_t players, int player, enum colorCard *c){
     char color=0;
     char choice=0;
+    if (coSelf() != NULL)
+    {
+        prompt_t p = {.kind = PROMPT_BID2, .player = player, .take = false, .color = NONE};
+        waitReply(&p);
+        if (!p.take || p.color == NONE) return false;
+        *c = p.color;
+        return true;
+    }
     printf("Tu prend l'atout T2 ? \n");
     printf("yes=1,no=0 :");
     scanf(" %c",&choice);
@@ -105,29 +124,140 @@ bool askTakeAtoutTurn2(players_t players, int player, enum colorCard *c){
         scanf(" %c",&color);
     } while (!verifColor(color));
     
-    *c=color;
+    *c=strchr("HCPT",color)-"HCPT";
     printf("Color : %c\n",color);
     return true;
 }
 
 /**
  * @brief Asks a player which card they want to play
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player being asked
+ * @param[in] legal Set of cards the player is allowed to play
  * @return The card chosen by the player
- * @todo Implement proper card selection logic
+ * @todo Implement network communication for remote players (send legal, read the card)
  */
-enum card askCard(players_t players, int player){
+enum card askCard(players_t players, int player, cardSet_t legal){
     // if(player == 0){CLient INTERNE}
-    printf("Tu met quel card ? \n");
-    char choice;
-    scanf(" %c",&choice);
-    if(choice == '1') return true; 
-    return false;
+    char name[8];
+    enum card card = NOTHING;
+    if (coSelf() != NULL)
+    {
+        prompt_t p = {.kind = PROMPT_CARD, .player = player, .legal = legal, .card = NOTHING};
+        waitReply(&p);
+        return p.card;
+    }
+    printf("Tu met quel card ? ");
+    afficherEq(legal);
+    printf("\n");
+    if (scanf(" %7s",name) != 1 || !string_to_card(name,&card)) return NOTHING;
+    return card;
+}
+
+// ==================== RANDOM =====================================================
+
+/**
+ * @brief Seeds a generator
+ * @param[out] rng Generator to seed
+ * @param[in] seed Initial state
+ * @param[in] stream Sequence selector
+ */
+void rngSeed(rng_t *rng, uint64_t seed, uint64_t stream){
+    rng->state = 0;
+    rng->inc = (stream << 1) | 1;
+    rngNext(rng);
+    rng->state += seed;
+    rngNext(rng);
+}
+
+/**
+ * @brief Draws the next 32-bit number (PCG-XSH-RR)
+ * @param[in,out] rng Generator
+ * @return Uniform number in [0, 2^32[
+ */
+uint32_t rngNext(rng_t *rng){
+    uint64_t old = rng->state;
+    uint32_t xorshifted, rot;
+
+    rng->state = old * 6364136223846793005ULL + rng->inc;
+    xorshifted = ((old >> 18) ^ old) >> 27;
+    rot = old >> 59;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+/**
+ * @brief Draws a number below a bound without modulo bias
+ * @param[in,out] rng Generator
+ * @param[in] bound Exclusive upper bound (> 0)
+ * @return Uniform number in [0, bound[
+ * @note Multiply-shift with rejection of the few biased low products (Lemire)
+ */
+uint32_t rngBounded(rng_t *rng, uint32_t bound){
+    uint64_t m = (uint64_t)rngNext(rng) * bound;
+    uint32_t low = (uint32_t)m;
+
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {
+            m = (uint64_t)rngNext(rng) * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return m >> 32;
 }
 
 // ==================== VARIABLES =====================================================
 
+/**
+ * @brief Maps the byte of a suit (bit i = i-th card of the suit, AS,7,8,9,10,V,D,R)
+ *        to the same cards ordered by strength (bit r = card of rank r)
+ * @details Index 0 is the normal order (7,8,9,V,D,R,10,AS), index 1 the trump order
+ *          (7,8,D,R,10,AS,9,V). The highest card of a suit is then the highest set bit.
+ */
+static const uint8_t rankByte[2][256] = {{
+    0x00, 0x80, 0x01, 0x81, 0x02, 0x82, 0x03, 0x83, 0x04, 0x84, 0x05, 0x85, 0x06, 0x86, 0x07, 0x87,
+    0x40, 0xC0, 0x41, 0xC1, 0x42, 0xC2, 0x43, 0xC3, 0x44, 0xC4, 0x45, 0xC5, 0x46, 0xC6, 0x47, 0xC7,
+    0x08, 0x88, 0x09, 0x89, 0x0A, 0x8A, 0x0B, 0x8B, 0x0C, 0x8C, 0x0D, 0x8D, 0x0E, 0x8E, 0x0F, 0x8F,
+    0x48, 0xC8, 0x49, 0xC9, 0x4A, 0xCA, 0x4B, 0xCB, 0x4C, 0xCC, 0x4D, 0xCD, 0x4E, 0xCE, 0x4F, 0xCF,
+    0x10, 0x90, 0x11, 0x91, 0x12, 0x92, 0x13, 0x93, 0x14, 0x94, 0x15, 0x95, 0x16, 0x96, 0x17, 0x97,
+    0x50, 0xD0, 0x51, 0xD1, 0x52, 0xD2, 0x53, 0xD3, 0x54, 0xD4, 0x55, 0xD5, 0x56, 0xD6, 0x57, 0xD7,
+    0x18, 0x98, 0x19, 0x99, 0x1A, 0x9A, 0x1B, 0x9B, 0x1C, 0x9C, 0x1D, 0x9D, 0x1E, 0x9E, 0x1F, 0x9F,
+    0x58, 0xD8, 0x59, 0xD9, 0x5A, 0xDA, 0x5B, 0xDB, 0x5C, 0xDC, 0x5D, 0xDD, 0x5E, 0xDE, 0x5F, 0xDF,
+    0x20, 0xA0, 0x21, 0xA1, 0x22, 0xA2, 0x23, 0xA3, 0x24, 0xA4, 0x25, 0xA5, 0x26, 0xA6, 0x27, 0xA7,
+    0x60, 0xE0, 0x61, 0xE1, 0x62, 0xE2, 0x63, 0xE3, 0x64, 0xE4, 0x65, 0xE5, 0x66, 0xE6, 0x67, 0xE7,
+    0x28, 0xA8, 0x29, 0xA9, 0x2A, 0xAA, 0x2B, 0xAB, 0x2C, 0xAC, 0x2D, 0xAD, 0x2E, 0xAE, 0x2F, 0xAF,
+    0x68, 0xE8, 0x69, 0xE9, 0x6A, 0xEA, 0x6B, 0xEB, 0x6C, 0xEC, 0x6D, 0xED, 0x6E, 0xEE, 0x6F, 0xEF,
+    0x30, 0xB0, 0x31, 0xB1, 0x32, 0xB2, 0x33, 0xB3, 0x34, 0xB4, 0x35, 0xB5, 0x36, 0xB6, 0x37, 0xB7,
+    0x70, 0xF0, 0x71, 0xF1, 0x72, 0xF2, 0x73, 0xF3, 0x74, 0xF4, 0x75, 0xF5, 0x76, 0xF6, 0x77, 0xF7,
+    0x38, 0xB8, 0x39, 0xB9, 0x3A, 0xBA, 0x3B, 0xBB, 0x3C, 0xBC, 0x3D, 0xBD, 0x3E, 0xBE, 0x3F, 0xBF,
+    0x78, 0xF8, 0x79, 0xF9, 0x7A, 0xFA, 0x7B, 0xFB, 0x7C, 0xFC, 0x7D, 0xFD, 0x7E, 0xFE, 0x7F, 0xFF,
+}, {
+    0x00, 0x20, 0x01, 0x21, 0x02, 0x22, 0x03, 0x23, 0x40, 0x60, 0x41, 0x61, 0x42, 0x62, 0x43, 0x63,
+    0x10, 0x30, 0x11, 0x31, 0x12, 0x32, 0x13, 0x33, 0x50, 0x70, 0x51, 0x71, 0x52, 0x72, 0x53, 0x73,
+    0x80, 0xA0, 0x81, 0xA1, 0x82, 0xA2, 0x83, 0xA3, 0xC0, 0xE0, 0xC1, 0xE1, 0xC2, 0xE2, 0xC3, 0xE3,
+    0x90, 0xB0, 0x91, 0xB1, 0x92, 0xB2, 0x93, 0xB3, 0xD0, 0xF0, 0xD1, 0xF1, 0xD2, 0xF2, 0xD3, 0xF3,
+    0x04, 0x24, 0x05, 0x25, 0x06, 0x26, 0x07, 0x27, 0x44, 0x64, 0x45, 0x65, 0x46, 0x66, 0x47, 0x67,
+    0x14, 0x34, 0x15, 0x35, 0x16, 0x36, 0x17, 0x37, 0x54, 0x74, 0x55, 0x75, 0x56, 0x76, 0x57, 0x77,
+    0x84, 0xA4, 0x85, 0xA5, 0x86, 0xA6, 0x87, 0xA7, 0xC4, 0xE4, 0xC5, 0xE5, 0xC6, 0xE6, 0xC7, 0xE7,
+    0x94, 0xB4, 0x95, 0xB5, 0x96, 0xB6, 0x97, 0xB7, 0xD4, 0xF4, 0xD5, 0xF5, 0xD6, 0xF6, 0xD7, 0xF7,
+    0x08, 0x28, 0x09, 0x29, 0x0A, 0x2A, 0x0B, 0x2B, 0x48, 0x68, 0x49, 0x69, 0x4A, 0x6A, 0x4B, 0x6B,
+    0x18, 0x38, 0x19, 0x39, 0x1A, 0x3A, 0x1B, 0x3B, 0x58, 0x78, 0x59, 0x79, 0x5A, 0x7A, 0x5B, 0x7B,
+    0x88, 0xA8, 0x89, 0xA9, 0x8A, 0xAA, 0x8B, 0xAB, 0xC8, 0xE8, 0xC9, 0xE9, 0xCA, 0xEA, 0xCB, 0xEB,
+    0x98, 0xB8, 0x99, 0xB9, 0x9A, 0xBA, 0x9B, 0xBB, 0xD8, 0xF8, 0xD9, 0xF9, 0xDA, 0xFA, 0xDB, 0xFB,
+    0x0C, 0x2C, 0x0D, 0x2D, 0x0E, 0x2E, 0x0F, 0x2F, 0x4C, 0x6C, 0x4D, 0x6D, 0x4E, 0x6E, 0x4F, 0x6F,
+    0x1C, 0x3C, 0x1D, 0x3D, 0x1E, 0x3E, 0x1F, 0x3F, 0x5C, 0x7C, 0x5D, 0x7D, 0x5E, 0x7E, 0x5F, 0x7F,
+    0x8C, 0xAC, 0x8D, 0xAD, 0x8E, 0xAE, 0x8F, 0xAF, 0xCC, 0xEC, 0xCD, 0xED, 0xCE, 0xEE, 0xCF, 0xEF,
+    0x9C, 0xBC, 0x9D, 0xBD, 0x9E, 0xBE, 0x9F, 0xBF, 0xDC, 0xFC, 0xDD, 0xFD, 0xDE, 0xFE, 0xDF, 0xFF,
+}};
+
+/**
+ * @brief Inverse of rankByte: position in the suit of the card of rank r
+ */
+static const uint8_t cardOfRank[2][8] = {
+    {1, 2, 3, 5, 6, 7, 4, 0},   ///< 7,8,9,V,D,R,10,AS
+    {1, 2, 6, 7, 4, 0, 3, 5}    ///< 7,8,D,R,10,AS,9,V
+};
+
 /**
  * @brief Gets the point value of a non-trump card
  * @param[in] card Card to evaluate
@@ -155,7 +285,7 @@ int getValueAtoutCard(enum card card){
  * @param[in] card Card to get the name of
  * @return String representation of the card
  */
-char* getNameCard(enum card card){
+const char* getNameCard(enum card card){
     const char *CARD_NAMES[NB_CARD_DECK] = {
     "H_AS","H_7","H_8","H_9","H_10","H_V","H_D","H_R",
     "C_AS","C_7","C_8","C_9","C_10","C_V","C_D","C_R",
@@ -183,28 +313,23 @@ enum card dealCard(pileCard_t* pileDeck){
 
 /**
  * @brief Resets all cards to initial state for a new round
- * @param[out] pileDeck Deck to reset
- * @param[out] pileEq1 Team 1's won cards pile to reset
- * @param[out] pileEq2 Team 2's won cards pile to reset
- * @param[out] players Array of players whose hands will be cleared
+ * @param[in,out] t Table whose deck, team piles, trick and hands are reset
  */
-void resetCards(pileCard_t* pileDeck,pileCard_t* pileEq1,pileCard_t* pileEq2, players_t players){
+void resetCards(table_t *t){
     for (int i = 0; i < 32; i++)
     {
-        pileEq1->deck[i]=NOTHING;
-        pileEq1->lastcard = 0;
-        pileEq2->deck[i]=NOTHING;
-        pileEq2->lastcard = 0;
-        pileDeck->deck[i]=i;
-        pileDeck->lastcard = 0;
+        t->deck.deck[i]=i;
     }
-    pileDeck->lastcard = 0;
+    t->deck.lastcard = 0;
+    t->piles[EQUIPE1] = 0;
+    t->piles[EQUIPE2] = 0;
     for (int i = 0; i < PLAYERS_MAX; i++){
-        for (int j = 0; j < NB_CARD_HAND; j++)
-            {players[i]->cards[j]=NOTHING;}
-        players[i]->s = FINISH; 
-        //players[i]->num = i;   
+        t->players[i].cards = 0;
+        t->players[i].s = FINISH; 
+        t->pli[i] = NOTHING;
     }
+    t->nbCardPli = 0;
+    t->retourne = NOTHING;
 }
 
 /**
@@ -231,31 +356,15 @@ int string_to_card(const char *s, enum card *out) {
  * @param[in] c Trump suit
  * @return Total points earned by the specified team
  */
-int point_of_gain(pileCard_t* pileEq1,pileCard_t* pileEq2, enum equipe eq,enum colorCard c){
+int point_of_gain(cardSet_t pileEq1,cardSet_t pileEq2, enum equipe eq,enum colorCard c){
     int points=0;
-    enum colorCard color=0;
-    int numero=0;
-    int i=0;
     enum card card;
+    cardSet_t pile = (eq == EQUIPE1) ? pileEq1 : pileEq2;
 
-    if (eq == EQUIPE1){
-        while ((card=pileEq1->deck[i])!=NOTHING)
-        {
-            color = card2Color(card);
-            numero = card - color*8;
-            points+=(color==c)?getValueAtoutCard(card):getValueCard(card);
-            i++;
-        }
-    }
-    else
+    for (; pile; pile &= pile - 1)
     {
-       while ((card=pileEq2->deck[i])!=NOTHING)
-        {
-            color = card2Color(card);
-            numero = card - color*8;
-            points+=(color==c)?getValueAtoutCard(card):getValueCard(card);
-            i++;
-        } 
+        card = __builtin_ctz(pile);
+        points+=(card2Color(card)==c)?getValueAtoutCard(card):getValueCard(card);
     }
     return points;
 }
@@ -263,16 +372,16 @@ int point_of_gain(pileCard_t* pileEq1,pileCard_t* pileEq2, enum equipe eq,enum c
 /**
  * @brief Shuffles the deck randomly
  * @param[in,out] pileDeck Deck to shuffle
+ * @param[in,out] rng Generator to draw from
  * @note Uses Fisher-Yates shuffle algorithm
  */
-void cardShuffle(pileCard_t* pileDeck) {
+void cardShuffle(pileCard_t* pileDeck, rng_t *rng) {
     for (int i = NB_CARD_DECK - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
+        int j = rngBounded(rng, i + 1);
         enum card temp = pileDeck->deck[j];
         pileDeck->deck[j] = pileDeck->deck[i];
         pileDeck->deck[i] = temp;
     }
-    pileDeck->lastcard;
 }
 
 /**
@@ -294,215 +403,115 @@ bool verifColor(char color){
  * @note Considers trump hierarchy and card values
  */
 int betterInPli(pli_t pli, enum colorCard c){
+    cardSet_t set = pliToSet(pli);
+    enum card bestCard;
 
-    int color, numero, bestVal, val, bestP, bestColor;
-    enum card card, bestCard;
-    
-    bestCard = pli[0];
-    bestP = 0;
-    bestColor = card2Color(bestCard);
-    numero = bestCard - bestColor*8;
-    bestVal = (bestColor==c)?getValueAtoutCard(bestCard):getValueCard(bestCard);
-    for (int i = 1; i < PLAYERS_MAX; i++)
-    {
-        card = pli[i];
-        color = card2Color(card);
-        numero = card - color*8;
-        if (color==c)//Card is Atout
-        {        
-            if (bestColor==c){// Both are Atout
-                val = getValueAtoutCard(card);
-                if (val < bestVal) break; // new Card has a smaller value thant the old
-                // Both are atout and of same value -> 7 of Atout & 8 of Atout, so the biggest is the best                
-                if(val = bestVal && card<=bestCard) break; 
-            }
-            // old card isn't Atout
-               
-        }
-        else//Card isn't Atout
-        {
-            if(bestColor==c)break;//old is a Atout
-            val = getValueCard(card);
-            if (val < bestVal) break; // new Card has a smaller value thant the old
-            // Both are atout and of same value -> 7 of Atout & 8 of Atout, so the biggest is the best                
-            if(val = bestVal && card<=bestCard) break; 
-        }
-        bestColor = color;
-        bestCard = card;
-        bestP = i;
-    }
-    
+    // The highest trump wins, otherwise the highest card of the suit led
+    bestCard = highestCardInSet(set, c, c);
+    if (bestCard == NOTHING)
+        bestCard = highestCardInSet(set, card2Color(pli[0]), c);
+    for (int i = 0; i < PLAYERS_MAX; i++)
+        if (pli[i] == bestCard) return i;
+    return 0;
 }
 
 /**
- * @brief Initializes a card pile by allocating memory
- * @param[out] pile Pointer to pile pointer to initialize
- * @note Exits program on allocation failure
+ * @brief Cards of a set that beat a card of the same suit
+ * @param[in] set Set of cards to filter
+ * @param[in] card Card to beat
+ * @param[in] colorAtout Trump suit (selects the ranking)
+ * @return Cards of set in the suit of card ranked strictly above it
  */
-void initPile(pileCard_t **pile)
-{
-    *pile = malloc(sizeof(pileCard_t));
-    if (*pile == NULL)
-    {
-        perror("malloc");
-        exit(EXIT_FAILURE);
+static cardSet_t higherCardsInSet(cardSet_t set, enum card card, enum colorCard colorAtout){
+    enum colorCard color = card2Color(card);
+    int atout = (color == colorAtout);
+    cardSet_t higher = 0;
+    int rank;
+
+    if (color == NONE) return set;
+    rank = __builtin_ctz(rankByte[atout][1 << (card % 8)]);
+    for (set &= SUIT_MASK(color); set; set &= set - 1) {
+        enum card c = __builtin_ctz(set);
+        if (__builtin_ctz(rankByte[atout][1 << (c % 8)]) > rank) higher |= CARD_BIT(c);
     }
+    return higher;
 }
 
 /**
- * @brief Validates if a card can be legally played according to Belote rules
- * @param[in] players Array of player pointers
- * @param[in] pli Current trick
- * @param[in] player Index of player attempting to play
- * @param[in] colorAtout Trump suit
- * @param[in,out] colorPli Suit led in the trick (updated if first card)
- * @param[in] card Card the player wants to play
- * @return true if card is legal, false otherwise
+ * @brief Computes every card a player may legally play on the current trick
+ * @param[in] hand Cards in the player's hand
+ * @param[in] pli Current trick (cards in play order, NOTHING for empty slots)
+ * @param[in] trump Trump suit
+ * @param[in] seat Position of the player in the trick (0 = leads, 3 = plays last)
+ * @return Set of playable cards
  * @details Implements Belote rules:
  *          - Must follow suit if possible
  *          - Must trump if can't follow suit
  *          - Must overtrump if possible
  *          - Partner winning allows any card
  */
-bool verifCard(players_t players, pli_t pli, int player, enum colorCard colorAtout, enum colorCard * colorPli, enum card card){
-    /*
-    Follow suit
-        If you have at least one card of the suit that was led, you must play that suit.
-    If you don't have the suit led
-        a) The suit led is trump
-            You must play a trump if you have one.
-            If a trump has already been played in the trick, you must overtrump (play a higher trump) if possible.
-        b) The suit led is NOT trump
-            If you have trump and your partner is not currently winning the trick:
-                You must play a trump (cut).
-                You must overtrump if possible.
-                If your partner is winning the trick:
-                You may play any card (discard).
-                You may also play a trump.
-    */
-    int flag = 0,flag2=0;
-    int i=0;
-    int nbCardPli=0;
-    enum card maxAtoutCard = NOTHING;
-    enum card maxColorCard = NOTHING;
-    enum card maxAtoutCardPli = NOTHING;
-    enum card maxColorCardPli = NOTHING;
-    enum card maxCardPli = NOTHING;
-    enum colorCard colorCard = card2Color(card);
-
-    // if card is in Player hand then ok
-    for (i = 0; i < NB_CARD_HAND; i++)
-    {
-        if (players[player]->cards[i] == NOTHING) break;
-        if(card == players[player]->cards[i]) flag = 1;
+cardSet_t legalMoves(cardSet_t hand, pli_t pli, enum colorCard trump, int seat){
+    cardSet_t trumps = hand & SUIT_MASK(trump);
+    cardSet_t follow, over;
+    enum colorCard colorPli;
+    enum card best;
+    int winner;
+
+    if (seat == 0 || pli[0] == NOTHING) return hand;
+    colorPli = card2Color(pli[0]);
+    follow = hand & SUIT_MASK(colorPli);
+    best = highestCardInSet(pliToSet(pli), trump, trump);
+
+    // Trump is asked : follow and overtrump if possible
+    if (colorPli == trump) {
+        if (!follow) return hand;
+        over = higherCardsInSet(follow, best, trump);
+        return over ? over : follow;
     }
-    if(flag == 0) return false;
-    flag=0;
-    i=0;
+    // Follow suit
+    if (follow) return follow;
 
-    //if card is first in pli -> colorPli is now color of card. card is good
-    if (pli[0]==NOTHING){
-        *colorPli = colorCard;
-        return true;
-    }
-    *colorPli = card2Color(pli[0]);
-    maxAtoutCard = searchMaxCardInHand(players,player,colorAtout,colorAtout);
-    maxColorCard = searchMaxCardInHand(players,player,*colorPli,colorAtout);
+    // Partner (two seats before) is winning the trick : discard allowed
+    winner = betterInPli(pli, trump);
+    if (seat >= 2 && winner == seat - 2) return hand;
+    if (!trumps) return hand;
 
-    //if the player have the color in is hand he must play it
-    if(maxColorCard != NOTHING && card2Color(card) != *colorPli) return false;
+    // Must trump, overtrump a trump already played if possible
+    if (best == NOTHING) return trumps;
+    over = higherCardsInSet(trumps, best, trump);
+    return over ? over : hand;
+}
 
-    //Atout is asked
-    if (*colorPli == colorAtout)
-    {
-        //if the player have the atout color in is hand he must play and overcome if possible
-        // the player have the atout color in is hand he must play it -> done before
-        maxAtoutCardPli = searchMaxCardInPli(pli,colorAtout,colorAtout);
-        if(isOvercut(card,maxCardPli,colorAtout,*colorPli))
-        {
-            printf("maxAtoutCard =%s, maxCardPli=%s, card=%s\n",getNameCard(maxAtoutCard),getNameCard(maxCardPli),getNameCard(card));
-            printf("overcut maxAtoutCard =%d, overcut card =%d\n",isOvercut(maxAtoutCard,maxAtoutCardPli,colorAtout,*colorPli),isOvercut(card,maxAtoutCardPli,colorAtout,*colorPli));
-            printf("He is overcutting\n");
-            return true;
-        }
-        if (isOvercut(maxAtoutCard,maxCardPli,colorAtout,*colorPli))
-        {
-            printf("He didn't overcut\n");
-            return false;
-        }
-    }
-    else // atout isn't asked
-    {
-        if(maxAtoutCard == NOTHING){
-            printf("the player don't have atout in is hand\n");
-            return true;
-        }
+/**
+ * @brief Validates if a card can be legally played according to Belote rules
+ * @param[in] players Array of players
+ * @param[in] pli Current trick
+ * @param[in] player Index of player attempting to play
+ * @param[in] colorAtout Trump suit
+ * @param[in,out] colorPli Suit led in the trick (updated if first card)
+ * @param[in] card Card the player wants to play
+ * @return true if card is legal, false otherwise
+ */
+bool verifCard(players_t players, pli_t pli, int player, enum colorCard colorAtout, enum colorCard * colorPli, enum card card){
+    cardSet_t legal;
 
-        //search number of card in the pli 
-        while (i < PLAYERS_MAX && pli[i] != NOTHING){i++;}
-        nbCardPli = i;
-        i=0;        
-
-        //search in pli for the best card
-        maxAtoutCardPli = searchMaxCardInPli(pli,colorAtout,colorAtout);
-        maxColorCardPli = searchMaxCardInPli(pli,*colorPli,colorAtout);
-        if (maxAtoutCardPli != NOTHING)
-            maxCardPli = maxAtoutCardPli;
-        else
-            maxCardPli = maxColorCardPli;
-        //if your partner is wining the trick
-        if(nbCardPli>=2)
-            if (pli[nbCardPli-2]==maxCardPli)
-                return true;
-
-        // if the player overcut
-        if(isOvercut(card,maxCardPli,colorAtout,*colorPli))
-        {
-            printf("maxAtoutCard =%s, maxCardPli=%s, card=%s\n",getNameCard(maxAtoutCard),getNameCard(maxCardPli),getNameCard(card));
-            printf("overcut maxAtoutCard =%d, overcut card =%d\n",isOvercut(maxAtoutCard,maxAtoutCardPli,colorAtout,*colorPli),isOvercut(card,maxAtoutCardPli,colorAtout,*colorPli));
-            printf("He is overcutting\n");
-            return true;
-        }
-        // if the player can overcut but don't
-        if (isOvercut(maxAtoutCard,maxCardPli,colorAtout,*colorPli))
-        {
-            printf("He didn't overcut\n");
-            return false;
-        }
-    }
+    if (card == NOTHING) return false;
+    legal = legalMoves(players[player].cards, pli, colorAtout, NB_CARDS(pliToSet(pli)));
+    if (!HAS_CARD(legal, card)) return false;
+    *colorPli = (pli[0] == NOTHING) ? card2Color(card) : card2Color(pli[0]);
     return true;
 }
 
 /**
  * @brief Finds the highest value card of a specific suit in a player's hand
- * @param[in] players Array of player pointers
+ * @param[in] players Array of players
  * @param[in] player Index of the player
  * @param[in] color Suit to search for
  * @param[in] colorAtout Trump suit (affects value calculation)
  * @return The highest card of the specified suit, or NOTHING if none found
  */
 enum card searchMaxCardInHand(players_t players, int player, enum colorCard color, enum colorCard colorAtout){
-    enum card maxCard = NOTHING;
-
-    if(color == colorAtout){
-        for (int i = 0; i < NB_CARD_HAND; i++)
-        {
-            if (players[player]->cards[i] == NOTHING) break;
-            if (color == card2Color(players[player]->cards[i])) {
-                if(getValueAtoutCard(players[player]->cards[i]) > getValueAtoutCard(maxCard)) maxCard = players[player]->cards[i];
-                if(getValueAtoutCard(players[player]->cards[i]) == getValueAtoutCard(maxCard) && players[player]->cards[i] > maxCard) maxCard = players[player]->cards[i];
-            }
-        }
-    }
-    else for (int i = 0; i < NB_CARD_HAND; i++)
-    {
-        if (players[player]->cards[i] == NOTHING) break;
-        if (color == card2Color(players[player]->cards[i])) {
-            if(getValueCard(players[player]->cards[i]) > getValueCard(maxCard)) maxCard = players[player]->cards[i];
-            if(getValueCard(players[player]->cards[i]) == getValueCard(maxCard) && players[player]->cards[i] > maxCard) maxCard = players[player]->cards[i];
-        }
-    }
-    return maxCard;
+    return highestCardInSet(players[player].cards, color, colorAtout);
 }
 
 /**
@@ -513,26 +522,53 @@ enum card searchMaxCardInHand(players_t players, int player, enum colorCard colo
  * @return The highest card of the specified suit, or NOTHING if none found
  */
 enum card searchMaxCardInPli(pli_t pli, enum colorCard color,enum colorCard colorAtout){
-    enum card maxCard = NOTHING;
-    if(color == colorAtout){
-        for (int i = 0; i < PLAYERS_MAX; i++)
-        {
-            if (pli[i] == NOTHING) break;
-            if (color == card2Color(pli[i])) {
-                if(getValueAtoutCard(pli[i]) > getValueAtoutCard(maxCard)) maxCard = pli[i];
-                if(getValueAtoutCard(pli[i]) == getValueAtoutCard(maxCard) && pli[i] > maxCard) maxCard = pli[i];
-            }
-        }
-    }
-    else for (int i = 0; i < PLAYERS_MAX; i++)
-    {
-        if (pli[i] == NOTHING) break;
-        if (color == card2Color(pli[i])) {
-            if(getValueCard(pli[i]) > getValueCard(maxCard)) maxCard = pli[i];
-            if(getValueCard(pli[i]) == getValueCard(maxCard) && pli[i] > maxCard) maxCard = pli[i];
-        }
-    }
-    return maxCard;
+    return highestCardInSet(pliToSet(pli), color, colorAtout);
+}
+
+/**
+ * @brief Finds the highest ranked card of a suit in a set of cards
+ * @param[in] set Set of cards to search
+ * @param[in] color Suit to search for
+ * @param[in] colorAtout Trump suit (selects the trump ranking when color is trump)
+ * @return The highest card of the specified suit, or NOTHING if none found
+ */
+enum card highestCardInSet(cardSet_t set, enum colorCard color, enum colorCard colorAtout){
+    int atout = (color == colorAtout);
+    unsigned ranks;
+
+    if (color == NONE) return NOTHING;
+    ranks = rankByte[atout][(set >> (color * 8)) & 0xFF];
+    if (ranks == 0) return NOTHING;
+    return color * 8 + cardOfRank[atout][31 - __builtin_clz(ranks)];
+}
+
+/**
+ * @brief Finds the lowest ranked card of a suit in a set of cards
+ * @param[in] set Set of cards to search
+ * @param[in] color Suit to search for
+ * @param[in] colorAtout Trump suit (selects the trump ranking when color is trump)
+ * @return The lowest card of the specified suit, or NOTHING if none found
+ */
+enum card lowestCardInSet(cardSet_t set, enum colorCard color, enum colorCard colorAtout){
+    int atout = (color == colorAtout);
+    unsigned ranks;
+
+    if (color == NONE) return NOTHING;
+    ranks = rankByte[atout][(set >> (color * 8)) & 0xFF];
+    if (ranks == 0) return NOTHING;
+    return color * 8 + cardOfRank[atout][__builtin_ctz(ranks)];
+}
+
+/**
+ * @brief Builds the set of cards already played in a trick
+ * @param[in] pli Current trick
+ * @return Set of the cards in the trick
+ */
+cardSet_t pliToSet(pli_t pli){
+    cardSet_t set = 0;
+    for (int i = 0; i < PLAYERS_MAX; i++)
+        if (pli[i] != NOTHING) set |= CARD_BIT(pli[i]);
+    return set;
 }
 
 /**
@@ -546,8 +582,6 @@ enum card searchMaxCardInPli(pli_t pli, enum colorCard color,enum colorCard colo
 bool isOvercut(enum card maxPlayerCard, enum card maxPliCard, enum colorCard colorAtout, enum colorCard colorPli){
     enum colorCard colorPlayerCard = card2Color(maxPlayerCard);
     enum colorCard colorPliCard = card2Color(maxPliCard);
-    int numeroPlayerCard = maxPlayerCard - colorPlayerCard*8;
-    int numeroPliCard = maxPliCard - colorPliCard*8;
 
     //Player card isn't colorPli
     if(colorPlayerCard != colorPli && colorPlayerCard != colorAtout) return false;
@@ -555,14 +589,13 @@ bool isOvercut(enum card maxPlayerCard, enum card maxPliCard, enum colorCard col
     if(colorPlayerCard != colorAtout && colorPliCard == colorAtout) return false;
     //Player card is Atout and Pli card isn't Atout
     if(colorPlayerCard == colorAtout &&colorPliCard != colorAtout) return true;
-    //Both are not Atout
-    if(colorPlayerCard != colorAtout && colorPliCard != colorAtout){
-        if(getValueCard(maxPlayerCard) > getValueCard(maxPliCard)) return true;
-        return false;
-    }
-    //Both are Atout
-    if(getValueAtoutCard(maxPlayerCard) > getValueAtoutCard(maxPliCard)) return true;
-    return false;
+    //No card to beat
+    if(maxPliCard == NOTHING) return true;
+    //Both are of the same suit : the strongest is the highest of the pair
+    if(colorPlayerCard == colorPliCard)
+        return highestCardInSet(CARD_BIT(maxPlayerCard) | CARD_BIT(maxPliCard), colorPliCard, colorAtout) == maxPlayerCard;
+    //Player card follows the suit led, pli card is another discarded suit
+    return colorPlayerCard == colorPli && colorPliCard != colorPli;
 }
 
 /**
@@ -578,229 +611,256 @@ enum colorCard card2Color(enum card card){
 // ==================== GAME ==============================================
 
 /**
- * @brief Performs the first deal (3 cards to each player)
- * @param[in,out] deck Deck to deal from
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[in] pli Current trick (for display)
+ * @brief Initializes a table for a new game
+ * @param[out] t Table to initialize
+ * @param[in] seed Seed of the table's random generator
  */
-void firstDeal(pileCard_t* deck, players_t players, int * startPlayer, pli_t pli){
-    int i=0;
-    int playingPlayer=nextPlayingPlayer(startPlayer,i);
-    do
+void tableInit(table_t *t, uint64_t seed){
+    memset(t, 0, sizeof(table_t));
+    for (int i = 0; i < PLAYERS_MAX; i++)
     {
-        players[playingPlayer]->cards[0]=dealCard(deck);
-        players[playingPlayer]->cards[1]=dealCard(deck);
-        players[playingPlayer]->cards[2]=dealCard(deck);
-        giveCard(players, playingPlayer);
-        i++;
-    } while ((playingPlayer=nextPlayingPlayer(startPlayer,i))!=*startPlayer);
-    givePli(players, pli);
+        t->players[i].num = i;
+        t->pli[i] = NOTHING;
+    }
+    t->retourne = NOTHING;
+    t->trump = NONE;
+    t->taker = -1;
+    rngSeed(&t->rng, seed, 1);
+    t->phase = PHASE_DEAL;
 }
 
 /**
- * @brief Conducts the trump selection phase
- * @param[in] players Array of player pointers
- * @param[in] turn Round of bidding (1 or 2)
- * @param[in] startPlayer Pointer to the starting player index
- * @param[out] c Chosen trump suit (only set in round 2)
- * @return Index of player who accepted trump, or -1 if all passed
+ * @brief Performs the first deal (3 cards to each player)
+ * @param[in,out] t Table to deal on
  */
-int playerTurnAtout(players_t players, int turn,int * startPlayer,enum colorCard *c){
-    int i=0;
-    int playingPlayer=nextPlayingPlayer(startPlayer,i);
-    do
+void firstDeal(table_t *t){
+    for (int i = 0; i < PLAYERS_MAX; i++)
     {
-        if(turn == 1)
-            {if(askTakeAtout(players, playingPlayer))return playingPlayer;}
-        else
-            {if(askTakeAtoutTurn2(players,playingPlayer,c))return playingPlayer;}
-        i++;   
-    } while ((playingPlayer=nextPlayingPlayer(startPlayer,i))!=*startPlayer);
-    return -1;
+        player_t *p = &t->players[nextPlayingPlayer(&t->dealer,i)];
+        p->cards|=CARD_BIT(dealCard(&t->deck));
+        p->cards|=CARD_BIT(dealCard(&t->deck));
+        p->cards|=CARD_BIT(dealCard(&t->deck));
+    }
 }
 
 /**
  * @brief Performs the second deal (2 cards to each player + reveal trump card)
- * @param[in,out] deck Deck to deal from
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[out] pli Current trick (stores revealed trump card)
+ * @param[in,out] t Table to deal on
  */
-void secondDeal(pileCard_t* deck, players_t players,int* startPlayer,pli_t pli){
-    int i=0;
-    int playingPlayer=nextPlayingPlayer(startPlayer,i);
-    do
+void secondDeal(table_t *t){
+    for (int i = 0; i < PLAYERS_MAX; i++)
     {
-        players[playingPlayer]->cards[3]=dealCard(deck);
-        players[playingPlayer]->cards[4]=dealCard(deck);
-        giveCard(players, playingPlayer);  
-        i++;
-    } while ((playingPlayer=nextPlayingPlayer(startPlayer,i))!=*startPlayer);
-    pli[0]=dealCard(deck);
+        player_t *p = &t->players[nextPlayingPlayer(&t->dealer,i)];
+        p->cards|=CARD_BIT(dealCard(&t->deck));
+        p->cards|=CARD_BIT(dealCard(&t->deck));
+    }
+    t->retourne=dealCard(&t->deck);
 }
 
 /**
  * @brief Performs the third deal (3 cards to each player, trump taker gets revealed card)
- * @param[in,out] deck Deck to deal from
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[in,out] pli Current trick (trump card will be taken)
- * @param[in] playerTakeAtout Index of player who accepted trump
+ * @param[in,out] t Table to deal on (t->taker must be set)
  */
-void thirdDeal(pileCard_t* deck, players_t players,int* startPlayer, pli_t pli, int playerTakeAtout){
-    int i=0;
-    int playingPlayer=nextPlayingPlayer(startPlayer,i);
-    do
+void thirdDeal(table_t *t){
+    for (int i = 0; i < PLAYERS_MAX; i++)
     {
-        if(playingPlayer==playerTakeAtout){
-            players[playingPlayer]->cards[5]=pli[0];
-            pli[0]==NOTHING;
+        int playingPlayer = nextPlayingPlayer(&t->dealer,i);
+        player_t *p = &t->players[playingPlayer];
+        if(playingPlayer==t->taker){
+            p->cards|=CARD_BIT(t->retourne);
+            t->retourne=NOTHING;
         }
-        else players[playingPlayer]->cards[5]=dealCard(deck);
-        players[playingPlayer]->cards[6]=dealCard(deck);
-        players[playingPlayer]->cards[7]=dealCard(deck);
-        giveCard(players, playingPlayer); 
-        i++;   
-    } while ((playingPlayer=nextPlayingPlayer(startPlayer,i))!=*startPlayer);
+        else p->cards|=CARD_BIT(dealCard(&t->deck));
+        p->cards|=CARD_BIT(dealCard(&t->deck));
+        p->cards|=CARD_BIT(dealCard(&t->deck));
+    }
 }
 
 /**
- * @brief Manages the complete dealing phase including trump selection
- * @param[in,out] deck Deck to deal from
- * @param[out] pileEq1 Team 1's won cards pile (cleared)
- * @param[out] pileEq2 Team 2's won cards pile (cleared)
- * @param[out] players Players receiving cards
- * @param[in] startPlayer Pointer to the starting player index
- * @param[out] pli Current trick
- * @param[out] c Trump suit determined
- * @return true if trump was selected, false if all players passed
- */
-bool turnDeal(pileCard_t * deck, pileCard_t* pileEq1, pileCard_t* pileEq2, players_t players, int * startPlayer, pli_t pli,enum colorCard * c){
-    int i=0;
-    int playingPlayer=nextPlayingPlayer(startPlayer,i);
-    int p;
-    resetCards(deck,pileEq1,pileEq2, players);
-    cardShuffle(deck);
-    firstDeal(deck,players,startPlayer,pli);
-    secondDeal(deck,players,startPlayer,pli);
-    givePli(players,pli);
-    if((p = playerTurnAtout(players,1,startPlayer,c))==-1)
-        if((p = playerTurnAtout(players,2,startPlayer,c))==-1)
-            return false;
-    thirdDeal(deck,players,startPlayer,pli,p);
-    return true;
+ * @brief Starts a new round: shuffles, deals 5 cards to each player and reveals a card
+ * @param[in,out] t Table in PHASE_DEAL
+ * @note The table moves to PHASE_BID1, the dealer speaks first
+ */
+void tableDeal(table_t *t){
+    uint64_t seed = rngNext(&t->rng);
+    seed = (seed << 32) | rngNext(&t->rng);
+    tableDealSeed(t, seed);
 }
 
 /**
- * @brief Manages one complete trick of play
- * @param[in,out] deck Game deck (unused in this function)
- * @param[in,out] pileEq1 Team 1's won cards pile
- * @param[in,out] pileEq2 Team 2's won cards pile
- * @param[in,out] players Array of players
- * @param[in,out] startPlayer Pointer to starting player (updated to winner)
- * @param[in,out] pli Current trick
- * @param[in] c Trump suit
+ * @brief Starts a new round from a given shuffle seed
+ * @param[in,out] t Table in PHASE_DEAL
+ * @param[in] seed Seed of the shuffle, as recorded in dealSeed
  */
-void turnNormal(pileCard_t * deck, pileCard_t* pileEq1, pileCard_t* pileEq2, players_t players, int * startPlayer, pli_t pli,enum colorCard * c){
-    int i=0;
-    enum card card=NOTHING;
-    int playingPlayer=nextPlayingPlayer(startPlayer,i);
-    do
-    {
-        do
-        {
-            card = askCard(players, playingPlayer);
-        } while (verifCard(players, pli, playingPlayer, *c, c, card) == false);
-        okCard(players, playingPlayer);
-        pli[i]=card;
-        givePli(players, pli);
-        card=NOTHING;
-        i++;
-    } while ((playingPlayer=nextPlayingPlayer(startPlayer,i))!=*startPlayer);
+void tableDealSeed(table_t *t, uint64_t seed){
+    rng_t rng;
 
-    int winnerPli = betterInPli(pli, *c);
-    if (winnerPli % 2 == *startPlayer % 2){
-        //Equipe 1 win
-        for (int j = 0; j < PLAYERS_MAX; j++)
-        {
-            pileEq1->deck[pileEq1->lastcard]=pli[j];
-            pileEq1->lastcard++;
-            pli[j]=NOTHING;
-        }
+    rngSeed(&rng, seed, 0);
+    t->dealSeed = seed;
+    t->nbDeal++;
+    resetCards(t);
+    cardShuffle(&t->deck, &rng);
+    firstDeal(t);
+    secondDeal(t);
+    t->trump = NONE;
+    t->taker = -1;
+    t->nbPass = 0;
+    t->nbPli = 0;
+    t->toAct = t->dealer;
+    t->phase = PHASE_BID1;
+}
+
+/**
+ * @brief Applies a bid of the player to act
+ * @param[in,out] t Table in PHASE_BID1 or PHASE_BID2
+ * @param[in] player Player bidding
+ * @param[in] take true if the player takes
+ * @param[in] color Trump suit chosen (second round only)
+ * @return false if the bid is refused (wrong phase, not the player's turn, invalid suit)
+ * @note After four passes in the second round the table goes back to PHASE_DEAL
+ *       with the next dealer
+ */
+bool tableBid(table_t *t, int player, bool take, enum colorCard color){
+    if ((t->phase != PHASE_BID1 && t->phase != PHASE_BID2) || player != t->toAct) return false;
+    if (take)
+    {
+        if (t->phase == PHASE_BID1) color = card2Color(t->retourne);
+        else if (color < H || color > T) return false;
+        t->trump = color;
+        t->taker = player;
+        thirdDeal(t);
+        t->startPlayer = t->dealer;
+        t->toAct = t->dealer;
+        t->nbCardPli = 0;
+        t->phase = PHASE_PLAY;
+        return true;
     }
-    else{
-        //Equipe 2 win
-        for (int j = 0; j < PLAYERS_MAX; j++)
-        {
-            pileEq2->deck[pileEq2->lastcard]=pli[j];
-            pileEq2->lastcard++;
-            pli[j]=NOTHING;
-        }
+    t->toAct = nextPlayingPlayer(&t->toAct,1);
+    if (++t->nbPass < PLAYERS_MAX) return true;
+    t->nbPass = 0;
+    if (t->phase == PHASE_BID1)
+        t->phase = PHASE_BID2;
+    else
+    {
+        // Everybody passed : the next player deals again
+        t->dealer = nextPlayingPlayer(&t->dealer,1);
+        t->phase = PHASE_DEAL;
     }
+    return true;
 }
 
 /**
- * @brief Calculates the next player in turn order
- * @param[in] startPlayer Pointer to the starting player index
- * @param[in] nbNextPlayer Number of positions to advance
- * @return Index of the next player (0-3)
+ * @brief Set of cards the player to act may play
+ * @param[in] t Table in PHASE_PLAY
+ * @return Legal cards of t->toAct
  */
-int nextPlayingPlayer(int* startPlayer, int nbNextPlayer){
-    return (*startPlayer+nbNextPlayer)%PLAYERS_MAX;
+cardSet_t tableLegal(table_t *t){
+    return legalMoves(t->players[t->toAct].cards, t->pli, t->trump, t->nbCardPli);
 }
 
 /**
- * @brief Manages one complete round (manche) of Belote
- * @param[in,out] deck Game deck
- * @param[in,out] pileEq1 Team 1's won cards pile
- * @param[in,out] pileEq2 Team 2's won cards pile
- * @param[in,out] players Array of players
- * @param[in,out] startPlayer Pointer to starting player
- * @param[in,out] pli Current trick
- * @param[out] c Trump suit
- * @param[in,out] scoreEq1 Team 1's score (updated)
- * @param[in,out] scoreEq2 Team 2's score (updated)
- * @return true if round completed successfully, false if all players passed on trump
+ * @brief Closes the current trick: gives it to the winner's team, who leads the next one
+ * @param[in,out] t Table with a full trick
+ * @note After the last trick the round is scored and the table goes to PHASE_DEAL
+ *       (next dealer) or PHASE_END if a team reached POINT_WIN
  */
-bool manche(pileCard_t * deck, pileCard_t* pileEq1, pileCard_t* pileEq2, players_t players, int * startPlayer, pli_t pli,enum colorCard * c, int* scoreEq1, int* scoreEq2){
-    if(turnDeal( deck, pileEq1, pileEq2, players, startPlayer, pli, c)==false)
-        return false;
+static void endTrick(table_t *t){
+    // pli[i] was played by the i-th player after startPlayer
+    int winner = nextPlayingPlayer(&t->startPlayer, betterInPli(t->pli, t->trump));
 
-    for(int i =0; i < NB_CARD_DECK/NB_CARD_HAND; i++)
-        turnNormal( deck, pileEq1, pileEq2, players, startPlayer, pli, c);
+    t->piles[winner % 2] |= pliToSet(t->pli);
+    for (int j = 0; j < PLAYERS_MAX; j++)
+        t->pli[j]=NOTHING;
+    t->nbCardPli = 0;
+    t->startPlayer = winner;
+    t->toAct = winner;
+    if (++t->nbPli < NB_CARD_HAND) return;
 
-    *scoreEq1 += point_of_gain(pileEq1,pileEq2,EQUIPE1,*c);
-    *scoreEq2 += point_of_gain(pileEq1,pileEq2,EQUIPE2,*c);
+    t->scores[EQUIPE1] += point_of_gain(t->piles[EQUIPE1],t->piles[EQUIPE2],EQUIPE1,t->trump);
+    t->scores[EQUIPE2] += point_of_gain(t->piles[EQUIPE1],t->piles[EQUIPE2],EQUIPE2,t->trump);
+    t->dealer = nextPlayingPlayer(&t->dealer,1);
+    if (t->scores[EQUIPE1] >= POINT_WIN || t->scores[EQUIPE2] >= POINT_WIN)
+        t->phase = PHASE_END;
+    else
+        t->phase = PHASE_DEAL;
+}
 
+/**
+ * @brief Plays a card for the player to act
+ * @param[in,out] t Table in PHASE_PLAY
+ * @param[in] player Player playing
+ * @param[in] card Card played
+ * @return false if the move is refused (wrong phase, not the player's turn, illegal card)
+ */
+bool tablePlay(table_t *t, int player, enum card card){
+    if (t->phase != PHASE_PLAY || player != t->toAct) return false;
+    if (card == NOTHING || !HAS_CARD(tableLegal(t), card)) return false;
+
+    t->players[player].cards &= ~CARD_BIT(card);
+    t->pli[t->nbCardPli++] = card;
+    t->toAct = nextPlayingPlayer(&t->toAct,1);
+    if (t->nbCardPli == PLAYERS_MAX) endTrick(t);
     return true;
 }
 
 /**
- * @brief Main game loop managing complete Belote game until a team wins
- * @param[in] players Array of 4 players
+ * @brief Calculates the next player in turn order
+ * @param[in] startPlayer Pointer to the starting player index
+ * @param[in] nbNextPlayer Number of positions to advance
+ * @return Index of the next player (0-3)
  */
-void game(players_t players){
-    pileCard_t* deck;//les cartes existante dans le deck
-    int lastDeal = 0;
-    pileCard_t* gain_Eq1;
-    pileCard_t* gain_Eq2;
-    enum card pli[PLAYERS_MAX] = {NOTHING,NOTHING,NOTHING,NOTHING};
-    int startPlayer=0;
-    enum colorCard colorAtout;
-    int scoreEq1=0;
-    int scoreEq2=0;
+int nextPlayingPlayer(int* startPlayer, int nbNextPlayer){
+    return (*startPlayer+nbNextPlayer)%PLAYERS_MAX;
+}
 
-    initPile(&gain_Eq1);
-    initPile(&gain_Eq2);
-    initPile(&deck);
+/**
+ * @brief Main game loop driving a table with the interactive players until a team wins
+ * @param[in,out] t Table holding the 4 players
+ * @details Run inside a coroutine, every ask* suspends the table until its driver
+ *          resumes it with the reply (see prompt_t) and nothing is printed.
+ */
+void game(table_t *t){
+    enum colorCard color = NONE;
+    enum card card;
+    bool take;
+    int player;
+    bool console = coSelf() == NULL;
 
-    while (scoreEq1 < POINT_WIN || scoreEq2 < POINT_WIN)
+    while (t->phase != PHASE_END)
     {
-        manche(deck,gain_Eq1,gain_Eq2,players,&startPlayer,pli,&colorAtout,&scoreEq1,&scoreEq2);
-        afficherGainEq(deck,gain_Eq1,gain_Eq2);
-        printf("Score Equipe 1 : %d\n",scoreEq1);
-        printf("Score Equipe 2 : %d\n",scoreEq2);
+        switch (t->phase)
+        {
+        case PHASE_DEAL:
+            tableDeal(t);
+            if (console) printf("Donne n°%d : graine %016llx\n",t->nbDeal,(unsigned long long)t->dealSeed);
+            for (int i = 0; i < PLAYERS_MAX; i++)
+                giveCard(t->players, i);
+            givePli(t->players, (pli_t){t->retourne, NOTHING, NOTHING, NOTHING});
+            break;
+        case PHASE_BID1:
+            take = askTakeAtout(t->players, t->toAct);
+            tableBid(t, t->toAct, take, NONE);
+            break;
+        case PHASE_BID2:
+            take = askTakeAtoutTurn2(t->players, t->toAct, &color);
+            tableBid(t, t->toAct, take, color);
+            break;
+        case PHASE_PLAY:
+            player = t->toAct;
+            card = askCard(t->players, player, tableLegal(t));
+            if (!tablePlay(t, player, card)) break;
+            okCard(t->players, player);
+            givePli(t->players, t->pli);
+            if (console && t->nbPli == NB_CARD_HAND && t->nbCardPli == 0)
+            {
+                afficherGainEq(&t->deck,t->piles[EQUIPE1],t->piles[EQUIPE2]);
+                printf("Score Equipe 1 : %d\n",t->scores[EQUIPE1]);
+                printf("Score Equipe 2 : %d\n",t->scores[EQUIPE2]);
+            }
+            break;
+        default:
+            break;
+        }
     }
 }
 
@@ -841,9 +901,7 @@ void str_color(enum card card){
  * @param[in] pileEq1 Team 1's won cards
  * @param[in] pileEq2 Team 2's won cards
  */
-void afficherGainEq(pileCard_t* pileDeck,pileCard_t* pileEq1,pileCard_t* pileEq2){
-    int j=0;
-    enum card card=NOTHING;
+void afficherGainEq(pileCard_t* pileDeck,cardSet_t pileEq1,cardSet_t pileEq2){
     printf("Deck\n");
     afficherDeck(pileDeck);
     printf("Equipe1\n");
@@ -858,15 +916,14 @@ void afficherGainEq(pileCard_t* pileDeck,pileCard_t* pileEq1,pileCard_t* pileEq2
  * @brief Displays all cards in a team's won pile
  * @param[in] pileEq Team's card pile to display
  */
-void afficherEq(pileCard_t* pileEq){
-    int j=0;
+void afficherEq(cardSet_t pileEq){
     enum card card=NOTHING;
-    while ((card=pileEq->deck[j])!=NOTHING)
+    for (; pileEq; pileEq &= pileEq - 1)
     {
+        card = __builtin_ctz(pileEq);
         str_color(card);
         printf("-%s-",getNameCard(card));
         STR_COLOR_END;
-        j++;
     }
 }
 
@@ -892,18 +949,16 @@ void afficherDeck(pileCard_t* pileDeck){
 void afficherPlayers(players_t players){
     for (int i = 0; i < PLAYERS_MAX; i++)
     {
-        printf("player n°%d : state=%d\n",players[i]->num,players[i]->s);
-        for (int j = 0; j < NB_CARD_HAND; j++)
+        printf("player n°%d : state=%d\n",players[i].num,players[i].s);
+        for (cardSet_t hand = players[i].cards; hand; hand &= hand - 1)
         {
-            if(players[i]->cards[j]==NOTHING){
-                printf("-o-");
-            }
-            else{
-                str_color(players[i]->cards[j]);
-                printf("-%s-",getNameCard(players[i]->cards[j]));
-                STR_COLOR_END;
-            }
+            enum card card = __builtin_ctz(hand);
+            str_color(card);
+            printf("-%s-",getNameCard(card));
+            STR_COLOR_END;
         }
+        for (int j = NB_CARDS(players[i].cards); j < NB_CARD_HAND; j++)
+            printf("-o-");
         printf("\n");
     }
 }
@@ -927,6 +982,7 @@ void afficherPli(pli_t pli){
     printf("\n");
 }
 
+#ifdef MOTEUR_MAIN
 /**
  * @brief Main entry point of the program
  * @param[in] argc Number of command line arguments
@@ -935,38 +991,26 @@ void afficherPli(pli_t pli){
  */
 int main(int argc, char const *argv[])
 {
-    pileCard_t* deck;//les cartes existante dans le deck
-    int lastDeal = 0;
-    pileCard_t* gain_Eq1;
-    pileCard_t* gain_Eq2;
-    enum card pli[PLAYERS_MAX] = {NOTHING,NOTHING,NOTHING,NOTHING};
-    player_t *players[PLAYERS_MAX];
-    int startPlayer=0;
-    //enum colorCard colorAtout;
-    //enum colorCard colorPli=NONE;
-
-    int nbPlayer=0;
+    table_t table;
+
     STR_ROUGE_START;
     printf("TEST\n");
     STR_COLOR_END;
     
     // =============================================================
     //création des 4 joueur - connection des clients
-    while (nbPlayer < 4)
+    tableInit(&table, time(NULL));
+    while (table.nbPlayer < PLAYERS_MAX)
     {
-        addPlayer(players,&nbPlayer);
+        addPlayer(table.players,&table.nbPlayer);
     }
-    afficherPlayers(players);
+    afficherPlayers(table.players);
     
     // =============================================================
     
-    initPile(&gain_Eq1);
-    initPile(&gain_Eq2);
-    initPile(&deck);
-    //turnDeal(deck,gain_Eq1,gain_Eq2,players,&startPlayer,pli,&colorAtout);
-    
-    
+    //game(&table);
 
     return 0;
 
-}
\ No newline at end of file
+}
+#endif // MOTEUR_MAIN
@@ -0,0 +1,191 @@
+/**
+ *	\file		parties.c
+ *	\brief		Implémentation de la table des parties en attente de joueurs
+ *	\author		Samir El Khattabi
+ *	\date		16 février 2026
+ *	\version	1.0
+ */
+#include <string.h>
+#include "../include/parties.h"
+/*
+*****************************************************************************************
+ *	\note		D E F I N I T I O N   DES   M A C R O S
+ */
+/**
+ *	\def		CHECK_ZERO(sts, msg)
+ *	\brief		Macro-fonction qui vérifie que sts est différent de 0 (cas d'erreur)
+ *				En cas d'erreur, il y a affichage du message adéquat et fin d'exécution
+ */
+#define CHECK_ZERO(sts, msg) if ((sts)!=0) {fprintf(stderr, "erreur threading: %s\n", msg); exit(-1);}
+/*
+*****************************************************************************************
+ *	\noop		D E C L A R A T I O N   DES   V A R I A B L E S    G L O B A L E S
+ */
+parties_t parties = {.premierLibre = -1, .listes = {[0 ... NB_PLACES] = -1},
+	.verrou = PTHREAD_MUTEX_INITIALIZER};
+/*
+*****************************************************************************************
+ *	\noop		I M P L E M E N T A T I O N   DES   F O N C T I O N S
+ */
+/**
+ *	\fn			static int placesLibres(const partie_t *p)
+ *	\brief		Nombre de places libres d'une partie, c'est aussi le numéro de sa liste
+ */
+static inline int placesLibres(const partie_t *p) {
+	return NB_PLACES - p->nbJoueurs;
+}
+/**
+ *	\fn			static void chainer(int indPartie)
+ *	\brief		Ajoute une partie incomplète en tête de la liste de son nombre de places libres
+ */
+static void chainer(int indPartie) {
+	partie_t *p = &parties.parties[indPartie];
+	int k = placesLibres(p);
+
+	if (k == 0 || k == NB_PLACES) return;		// complète ou vide : dans aucune liste
+	p->prec = -1;
+	p->suiv = parties.listes[k];
+	if (p->suiv != -1) parties.parties[p->suiv].prec = indPartie;
+	parties.listes[k] = indPartie;
+	parties.nonVides |= 1u << k;
+}
+/**
+ *	\fn			static void dechainer(int indPartie)
+ *	\brief		Retire une partie de la liste de son nombre de places libres
+ */
+static void dechainer(int indPartie) {
+	partie_t *p = &parties.parties[indPartie];
+	int k = placesLibres(p);
+
+	if (k == 0 || k == NB_PLACES) return;
+	if (p->prec != -1) parties.parties[p->prec].suiv = p->suiv;
+	else parties.listes[k] = p->suiv;
+	if (p->suiv != -1) parties.parties[p->suiv].prec = p->prec;
+	if (parties.listes[k] == -1) parties.nonVides &= ~(1u << k);
+}
+/**
+ *	\fn			static partie_t *valide(hPartie_t h)
+ *	\brief		Partie désignée par une poignée (verrou pris)
+ *	\return		La partie, NULL si la poignée est nulle ou périmée
+ */
+static partie_t *valide(hPartie_t h) {
+	partie_t *p;
+
+	if (h.index < 0 || h.index >= parties.nbParties) return NULL;
+	p = &parties.parties[h.index];
+	return (p->generation == h.generation && p->nbJoueurs > 0) ? p : NULL;
+}
+/**
+ *	\fn			static hPartie_t poignee(int indPartie)
+ *	\brief		Poignée de la génération courante d'un emplacement
+ */
+static inline hPartie_t poignee(int indPartie) {
+	return (hPartie_t){indPartie, parties.parties[indPartie].generation};
+}
+/**
+ *	\fn			static void ajouterJoueur(int indPartie, int indUser)
+ *	\brief		Ajoute un joueur à une partie incomplète et la change de liste
+ */
+static void ajouterJoueur(int indPartie, int indUser) {
+	partie_t *p = &parties.parties[indPartie];
+
+	dechainer(indPartie);
+	p->joueurs[p->nbJoueurs++] = indUser;
+	chainer(indPartie);
+	modifierPartie(indUser, poignee(indPartie));
+}
+/**
+ *	\fn			static void retirerJoueur(int indUser)
+ *	\brief		Retire un joueur de sa partie (verrou pris) ; la partie vide est libérée et
+ *				sa génération change, ce qui périme toutes ses poignées
+ */
+static void retirerJoueur(int indUser) {
+	hPartie_t h = partieUser(indUser);
+	partie_t *p;
+	int j;
+
+	if ((p = valide(h)) == NULL) return;
+	modifierPartie(indUser, PARTIE_NULLE);
+	dechainer(h.index);
+	for (j = 0; p->joueurs[j] != indUser; j++);
+	// Décalage : l'hôte reste en tête, son départ laisse la place au plus ancien joueur
+	memmove(&p->joueurs[j], &p->joueurs[j + 1], (p->nbJoueurs - j - 1) * sizeof(int));
+	if (--p->nbJoueurs > 0) {
+		chainer(h.index);
+		return;
+	}
+	p->generation++;
+	p->suiv = parties.premierLibre;
+	parties.premierLibre = h.index;
+}
+
+hPartie_t creerPartie(int indUser) {
+	int indPartie = -1;
+	hPartie_t h = PARTIE_NULLE;
+
+	CHECK_ZERO(pthread_mutex_lock(&parties.verrou), "pthread_mutex_lock");
+	retirerJoueur(indUser);
+	if (parties.premierLibre != -1) {
+		indPartie = parties.premierLibre;
+		parties.premierLibre = parties.parties[indPartie].suiv;
+	}
+	else if (parties.nbParties < MAX_PARTIES) indPartie = parties.nbParties++;
+	if (indPartie != -1) {
+		ajouterJoueur(indPartie, indUser);
+		h = poignee(indPartie);
+	}
+	CHECK_ZERO(pthread_mutex_unlock(&parties.verrou), "pthread_mutex_unlock");
+	return h;
+}
+int rejoindrePartie(int indUser, hPartie_t partie) {
+	hPartie_t actuelle = partieUser(indUser);
+	int sts = -1;
+
+	CHECK_ZERO(pthread_mutex_lock(&parties.verrou), "pthread_mutex_lock");
+	if (valide(partie) != NULL && (actuelle.index != partie.index || actuelle.generation != partie.generation)) {
+		retirerJoueur(indUser);
+		// Vérifié après retirerJoueur() : quitter sa partie peut avoir libéré celle-ci
+		if (valide(partie) != NULL && placesLibres(&parties.parties[partie.index]) > 0) {
+			ajouterJoueur(partie.index, indUser);
+			sts = 0;
+		}
+	}
+	CHECK_ZERO(pthread_mutex_unlock(&parties.verrou), "pthread_mutex_unlock");
+	return sts;
+}
+hPartie_t rejoindrePartieAlea(int indUser) {
+	hPartie_t h = PARTIE_NULLE;
+
+	CHECK_ZERO(pthread_mutex_lock(&parties.verrou), "pthread_mutex_lock");
+	retirerJoueur(indUser);
+	if (parties.nonVides != 0) {
+		h = poignee(parties.listes[__builtin_ctz(parties.nonVides)]);
+		ajouterJoueur(h.index, indUser);
+	}
+	CHECK_ZERO(pthread_mutex_unlock(&parties.verrou), "pthread_mutex_unlock");
+	return h;
+}
+void quitterPartie(int indUser) {
+	if (partieUser(indUser).index == -1) return;
+	CHECK_ZERO(pthread_mutex_lock(&parties.verrou), "pthread_mutex_lock");
+	retirerJoueur(indUser);
+	CHECK_ZERO(pthread_mutex_unlock(&parties.verrou), "pthread_mutex_unlock");
+}
+int hotePartie(hPartie_t partie) {
+	partie_t *p;
+	int hote = -1;
+
+	CHECK_ZERO(pthread_mutex_lock(&parties.verrou), "pthread_mutex_lock");
+	if ((p = valide(partie)) != NULL) hote = p->joueurs[0];
+	CHECK_ZERO(pthread_mutex_unlock(&parties.verrou), "pthread_mutex_unlock");
+	return hote;
+}
+int isFull(hPartie_t partie) {
+	partie_t *p;
+	int complete = 1;
+
+	CHECK_ZERO(pthread_mutex_lock(&parties.verrou), "pthread_mutex_lock");
+	if ((p = valide(partie)) != NULL) complete = placesLibres(p) == 0;
+	CHECK_ZERO(pthread_mutex_unlock(&parties.verrou), "pthread_mutex_unlock");
+	return complete;
+}
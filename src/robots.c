@@ -0,0 +1,204 @@
+/**
+ * @file robots.c
+ * @brief Automatic players for the Belote engine
+ * @author Raphael ALLO
+ * @date 14/02/2026
+ */
+#include "../include/robots.h"
+
+// ==================== TOOLS =============================================
+
+/**
+ * @brief Draws one card of a set uniformly
+ * @param[in] set Non empty set of cards
+ * @param[in,out] rng Generator
+ * @return A card of set
+ */
+static enum card randomCard(cardSet_t set, rng_t *rng){
+    for (int k = rngBounded(rng, NB_CARDS(set)); k > 0; k--)
+        set &= set - 1;
+    return __builtin_ctz(set);
+}
+
+/**
+ * @brief Point value of a card once the trump is known
+ * @param[in] card Card to evaluate
+ * @param[in] trump Trump suit
+ * @return Points of the card
+ */
+static int cardPoints(enum card card, enum colorCard trump){
+    return (card2Color(card) == trump) ? getValueAtoutCard(card) : getValueCard(card);
+}
+
+/**
+ * @brief Cheapest card of a set, trumps being kept as long as possible
+ * @param[in] set Non empty set of cards
+ * @param[in] trump Trump suit
+ * @return The card of set with the fewest points
+ */
+static enum card cheapestCard(cardSet_t set, enum colorCard trump){
+    enum card best = NOTHING;
+    int bestCost = 1000, cost;
+
+    for (; set; set &= set - 1)
+    {
+        enum card card = __builtin_ctz(set);
+        cost = cardPoints(card, trump) + ((card2Color(card) == trump) ? 100 : 0);
+        if (cost < bestCost) { bestCost = cost; best = card; }
+    }
+    return best;
+}
+
+// ==================== HASARD ============================================
+
+/**
+ * @brief Takes the revealed suit one time out of four
+ */
+static bool hasardBid1(table_t *t, int player, rng_t *rng){
+    return rngBounded(rng, 4) == 0;
+}
+
+/**
+ * @brief Takes one time out of three, on a random suit
+ */
+static bool hasardBid2(table_t *t, int player, enum colorCard *c, rng_t *rng){
+    if (rngBounded(rng, 3) != 0) return false;
+    *c = rngBounded(rng, 4);
+    return true;
+}
+
+/**
+ * @brief Plays any legal card
+ */
+static enum card hasardPlay(table_t *t, int player, cardSet_t legal, rng_t *rng){
+    return randomCard(legal, rng);
+}
+
+// ==================== GLOUTON ===========================================
+
+/**
+ * @brief Strength of a hand for a given trump: number of trumps, bonus for the jack and nine
+ */
+static int handStrength(cardSet_t hand, enum colorCard trump){
+    cardSet_t trumps = hand & SUIT_MASK(trump);
+    return NB_CARDS(trumps) * 2 + HAS_CARD(trumps, trump * 8 + 5) * 3 + HAS_CARD(trumps, trump * 8 + 3) * 2;
+}
+
+/**
+ * @brief Takes the revealed suit with a strong hand in that suit
+ */
+static bool gloutonBid1(table_t *t, int player, rng_t *rng){
+    enum colorCard trump = card2Color(t->retourne);
+    return handStrength(t->players[player].cards | CARD_BIT(t->retourne), trump) >= 9;
+}
+
+/**
+ * @brief Takes on the strongest suit if it is strong enough
+ */
+static bool gloutonBid2(table_t *t, int player, enum colorCard *c, rng_t *rng){
+    int best = 0, strength;
+
+    for (enum colorCard color = H; color <= T; color++)
+    {
+        strength = handStrength(t->players[player].cards, color);
+        if (strength > best) { best = strength; *c = color; }
+    }
+    return best >= 9;
+}
+
+/**
+ * @brief Wins the trick as cheaply as possible, otherwise discards the cheapest card
+ */
+static enum card gloutonPlay(table_t *t, int player, cardSet_t legal, rng_t *rng){
+    cardSet_t winning = 0;
+    pli_t pli;
+
+    memcpy(pli, t->pli, sizeof(pli_t));
+    for (cardSet_t set = legal; set; set &= set - 1)
+    {
+        pli[t->nbCardPli] = __builtin_ctz(set);
+        if (betterInPli(pli, t->trump) == t->nbCardPli) winning |= CARD_BIT(pli[t->nbCardPli]);
+    }
+    return cheapestCard(winning ? winning : legal, t->trump);
+}
+
+// ==================== PASSIF ============================================
+
+/**
+ * @brief Never takes
+ */
+static bool passifBid1(table_t *t, int player, rng_t *rng){
+    return false;
+}
+
+/**
+ * @brief Never takes
+ */
+static bool passifBid2(table_t *t, int player, enum colorCard *c, rng_t *rng){
+    return false;
+}
+
+/**
+ * @brief Discards the cheapest legal card (move played for an absent player)
+ */
+static enum card passifPlay(table_t *t, int player, cardSet_t legal, rng_t *rng){
+    return cheapestCard(legal, t->trump);
+}
+
+// ==================== REGISTRY ==========================================
+
+/**
+ * @brief Available robots
+ */
+static const policy_t policies[] = {
+    {"hasard",  hasardBid1,  hasardBid2,  hasardPlay},
+    {"glouton", gloutonBid1, gloutonBid2, gloutonPlay},
+    {"passif",  passifBid1,  passifBid2,  passifPlay}
+};
+
+/**
+ * @brief Finds a robot by name
+ * @param[in] name Name of the robot
+ * @return The robot, or NULL if no robot has this name
+ */
+const policy_t *findPolicy(const char *name){
+    for (int i = 0; i < (int)(sizeof(policies) / sizeof(policies[0])); i++)
+        if (strcmp(policies[i].name, name) == 0) return &policies[i];
+    return NULL;
+}
+
+/**
+ * @brief Lists the available robots
+ * @param[out] nb Number of robots
+ * @return Array of the robots
+ */
+const policy_t *listPolicies(int *nb){
+    *nb = sizeof(policies) / sizeof(policies[0]);
+    return policies;
+}
+
+/**
+ * @brief Asks a robot for the decision expected by the table and applies it
+ * @param[in,out] t Table in PHASE_BID1, PHASE_BID2 or PHASE_PLAY
+ * @param[in] policy Robot of the player to act
+ * @param[in,out] rng Generator of the calling thread
+ * @return false if the robot's answer was refused by the table
+ */
+bool policyStep(table_t *t, const policy_t *policy, rng_t *rng){
+    int player = t->toAct;
+    enum colorCard c = NONE;
+    bool take;
+
+    switch (t->phase)
+    {
+    case PHASE_BID1:
+        return tableBid(t, player, policy->bid1(t, player, rng), NONE);
+    case PHASE_BID2:
+        take = policy->bid2(t, player, &c, rng);
+        return tableBid(t, player, take, c);
+    case PHASE_PLAY:
+        return tablePlay(t, player, policy->play(t, player, tableLegal(t), rng));
+    default:
+        return false;
+    }
+}
@@ -46,6 +46,7 @@ void adr2struct(struct sockaddr_in * addr, char* adrIP, short port){
 socket_t creerSocket(int mode){
     if(mode != SOCK_STREAM && mode != SOCK_DGRAM) mode = SOCK_STREAM;
     socket_t s;
+    memset(&s, 0, sizeof(s));
     s.mode = mode;
     CHECK(s.fd=socket(PF_INET, mode, 0), "Can't create socket");
     return s;
@@ -71,7 +72,8 @@ socket_t creerSocketAddr(int mode, char* adrIp, int port){
 socket_t creerSocketEcoute(char* adrIP, short port){
 
     socket_t sock = creerSocketAddr(SOCK_STREAM, adrIP, port);
-    CHECK(listen(sock.fd, 5) , "Can't calibrate");
+    // file d'attente maximale : une rafale de connexions ne perd pas de SYN
+    CHECK(listen(sock.fd, SOMAXCONN) , "Can't calibrate");
     return sock;
 
 }
@@ -79,30 +81,56 @@ socket_t creerSocketEcoute(char* adrIP, short port){
 
 socket_t accepterClt (const socket_t sockEcoute){
     socket_t sock;
-    struct sockaddr_in clt;
-    socklen_t cltLen = sizeof(clt); // Initialisation importante
-    
-    sock.mode = sockEcoute.mode;
-    
-    // Correction ici : accept remplit la structure clt
-    CHECK(sock.fd = accept(sockEcoute.fd, (struct sockaddr *)&clt, &cltLen), "Can't accept");
-    
-    // On stocke l'adresse du client dans la socket de session
-    sock.addrDst = clt; 
+
+    CHECK(accepterCltSts(sockEcoute, &sock), "Can't accept");
     return sock;
 }
 
 
-
-
 socket_t connecterClt2Srv (char *adrIP, short port){
     socket_t sockDest;
+
+    CHECK(connecterClt2SrvSts(adrIP, port, &sockDest), "Can't connect");
+    return sockDest;
+}
+
+
+int accepterCltSts (const socket_t sockEcoute, socket_t *sock){
+    struct sockaddr_in clt;
+    socklen_t cltLen = sizeof(clt);
+    int fd;
+
+    while ((fd = accept(sockEcoute.fd, (struct sockaddr *)&clt, &cltLen)) == -1 && errno == EINTR);
+    if (fd == -1) return -1;
+    memset(sock, 0, sizeof(*sock));
+    sock->fd = fd;
+    sock->mode = sockEcoute.mode;
+    sock->addrDst = clt;
+    return 0;
+}
+
+
+int connecterClt2SrvSts (char *adrIP, short port, socket_t *sock){
     struct sockaddr_in svc;
-	    sockDest = creerSocket(SOCK_STREAM); 
+    int fd, err;
 
+    if ((fd = socket(PF_INET, SOCK_STREAM, 0)) == -1) return -1;
     adr2struct(&svc, adrIP, port);
+    if (connect(fd, (struct sockaddr *)&svc, sizeof svc) == -1) {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    memset(sock, 0, sizeof(*sock));
+    sock->fd = fd;
+    sock->mode = SOCK_STREAM;
+    return 0;
+}
 
-    CHECK(connect(sockDest.fd, (struct sockaddr *)&svc, sizeof svc) , "Can't connect");
-    return sockDest;
 
+int delaiReception (socket_t *sock, int delaiMs){
+    struct timeval tv = {delaiMs / 1000, (delaiMs % 1000) * 1000};
+
+    return setsockopt(sock->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
 }
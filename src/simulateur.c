@@ -0,0 +1,468 @@
+/**
+ * @file simulateur.c
+ * @brief Headless self-play simulator of the Belote engine
+ * @details Plays complete games between robots on N threads, each thread owning its
+ *          tables and generator, and reports the engine throughput (deals/s, tricks/s)
+ *          and the time spent in each phase. Optionally writes one line per deal
+ *          (seed, dealer, taker, trump, points) to build game corpora.
+ *          With -x, all the games are opened at once as tables spread over -t executor
+ *          threads, the robots answering through the executors' mailboxes like remote players
+ *          (no corpus nor per-phase timings in this mode).
+ *          With -c, each thread opens all its games at once, each one running the
+ *          sequential game() in a coroutine: the thread answers every question with the
+ *          robot of the player asked and resumes the table, as an event loop would on the
+ *          reply of a remote player (same results as the direct mode, no corpus nor timings).
+ *
+ *          With -x -d ms, each bid and card must come within ms, the executor playing
+ *          the cheapest move for a late player; -a leaves seat 0 empty so that all its
+ *          moves are played on timeout.
+ *
+ *          Usage : simulateur [-x [-d ms [-a]]|-c] [-t nbThreads] [-n nbGames] [-s seed] [-j bot0,bot1,bot2,bot3] [-o corpus]
+ * @author Raphael ALLO
+ * @date 14/02/2026
+ */
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/robots.h"
+#include "../include/executeur.h"
+#include "../include/coroutine.h"
+
+// ==================== STRUCTURES ========================================
+
+/**
+ * @struct simStats
+ * @brief Counters of one simulation thread
+ */
+typedef struct simStats {
+    long games;                 ///< Games played
+    long deals;                 ///< Deals dealt (including deals where everybody passed)
+    long tricks;                ///< Tricks played
+    long passes;                ///< Deals where everybody passed
+    long timeouts;              ///< Moves played by the executors on timeout (-x -d)
+    unsigned long long nsDeal;  ///< Time spent in tableDeal()
+    unsigned long long nsBid;   ///< Time spent in the bidding (robots + tableBid)
+    unsigned long long nsPlay;  ///< Time spent in the play (robots + tablePlay)
+} simStats_t;
+
+/**
+ * @struct simThread
+ * @brief Work and results of one simulation thread
+ */
+typedef struct simThread {
+    pthread_t th;                           ///< Thread
+    long firstGame;                         ///< Index of the first game to play
+    long nbGames;                           ///< Number of games to play
+    uint64_t seed;                          ///< Base seed of the simulation
+    const policy_t *robots[PLAYERS_MAX];    ///< Robot of each seat
+    FILE *corpus;                           ///< Corpus output, NULL if none
+    simStats_t stats;                       ///< Results
+} simThread_t;
+
+/**
+ * @struct execLocal
+ * @brief Data of one executor thread in the -x mode (own cache line)
+ */
+typedef struct execLocal {
+    simStats_t stats;                       ///< Counters of the executor's tables
+    rng_t rng;                              ///< Generator of the robots of the executor's tables
+} __attribute__((aligned(64))) execLocal_t;
+
+/**
+ * @struct execSim
+ * @brief Simulation driven by table executors (-x)
+ */
+typedef struct execSim {
+    executors_t pool;                       ///< Executors running the tables
+    const policy_t *robots[PLAYERS_MAX];    ///< Robot of each seat
+    bool absent;                            ///< Seat 0 never answers, its moves are played on timeout
+    bool timers;                            ///< Turn timers on: a robot's reply may come after its automatic move
+    execLocal_t *locals;                    ///< One per executor
+    long remaining;                         ///< Tables not yet closed
+    pthread_mutex_t lock;                   ///< Protects the end of the simulation
+    pthread_cond_t done;                    ///< Signaled when the last table is closed
+} execSim_t;
+
+// ==================== SIMULATION ========================================
+
+/**
+ * @brief Stops the program on a threading error
+ */
+static void checkZero(int sts, const char *msg){
+    if (sts != 0)
+    {
+        fprintf(stderr, "erreur threading: %s\n", msg);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Monotonic time in nanoseconds
+ */
+static unsigned long long nowNs(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Plays one complete game on a table
+ * @param[in,out] t Table initialized by tableInit()
+ * @param[in] sim Thread running the game (robots, corpus)
+ * @param[in,out] st Statistics of the thread
+ * @param[in,out] rng Generator of the robots
+ * @return false if a robot's answer was refused (engine or robot bug)
+ */
+static bool playGame(table_t *t, simThread_t *sim, simStats_t *st, rng_t *rng){
+    unsigned long long deb;
+    int scores[2] = {0, 0};
+    int dealer = 0;
+    bool ok = true;
+
+    while (ok && t->phase != PHASE_END)
+    {
+        deb = nowNs();
+        switch (t->phase)
+        {
+        case PHASE_DEAL:
+            if (t->nbDeal > 0 && t->nbPli < NB_CARD_HAND) st->passes++;
+            dealer = t->dealer;
+            tableDeal(t);
+            st->deals++;
+            st->nsDeal += nowNs() - deb;
+            break;
+        case PHASE_BID1:
+        case PHASE_BID2:
+            ok = policyStep(t, sim->robots[t->toAct], rng);
+            st->nsBid += nowNs() - deb;
+            break;
+        case PHASE_PLAY:
+            ok = policyStep(t, sim->robots[t->toAct], rng);
+            if (t->nbCardPli == 0) st->tricks++;
+            st->nsPlay += nowNs() - deb;
+            if (t->phase != PHASE_PLAY && sim->corpus != NULL)
+            {
+                fprintf(sim->corpus, "%016llx %d %d %d %d %d\n", (unsigned long long)t->dealSeed, dealer,
+                    t->taker, t->trump, t->scores[EQUIPE1] - scores[EQUIPE1], t->scores[EQUIPE2] - scores[EQUIPE2]);
+                scores[EQUIPE1] = t->scores[EQUIPE1];
+                scores[EQUIPE2] = t->scores[EQUIPE2];
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Body of a simulation thread: plays its share of the games
+ * @param[in,out] arg Thread context (simThread_t)
+ */
+static void *simulate(void *arg){
+    simThread_t *sim = (simThread_t *)arg;
+    simStats_t st = {0};    // local : threads never write to a shared cache line
+    table_t t;
+    rng_t rng;
+
+    for (long g = sim->firstGame; g < sim->firstGame + sim->nbGames; g++)
+    {
+        // Each game only depends on the base seed and its index, not on the thread count
+        tableInit(&t, sim->seed + g * 0x9E3779B97F4A7C15ULL);
+        rngSeed(&rng, sim->seed + g, 2);
+        if (!playGame(&t, sim, &st, &rng))
+        {
+            fprintf(stderr, "Partie %ld : coup refusé (donne %016llx)\n", g, (unsigned long long)t.dealSeed);
+            break;
+        }
+        st.games++;
+    }
+    sim->stats = st;
+    return NULL;
+}
+
+// ==================== COROUTINES (-c) ===================================
+
+/**
+ * @brief Body of a table's coroutine: the sequential game loop of the engine
+ * @param[in,out] arg Table (table_t)
+ */
+static void gameCoroutine(void *arg){
+    game((table_t *)arg);
+}
+
+/**
+ * @brief Allocates a zeroed array, stops the program if memory is exhausted
+ */
+static void *allocArray(long nb, size_t size){
+    void *p = calloc(nb, size);
+
+    if (p == NULL) { perror("calloc"); exit(EXIT_FAILURE); }
+    return p;
+}
+
+/**
+ * @brief Body of a simulation thread with -c: all its games suspended at once in coroutines
+ * @param[in,out] arg Thread context (simThread_t)
+ */
+static void *simulateCoroutines(void *arg){
+    simThread_t *sim = (simThread_t *)arg;
+    simStats_t st = {0};
+    long n = sim->nbGames, alive = n, g;
+    table_t *tables = allocArray(n, sizeof(table_t));
+    rng_t *rngs = allocArray(n, sizeof(rng_t));
+    coroutine_t *cos = allocArray(n, sizeof(coroutine_t));
+    prompt_t **asked = allocArray(n, sizeof(prompt_t *));
+    enum promptKind kind;
+    const policy_t *robot;
+    prompt_t *p;
+    table_t *t;
+
+    for (long i = 0; i < n; i++)
+    {
+        g = sim->firstGame + i;
+        tableInit(&tables[i], sim->seed + g * 0x9E3779B97F4A7C15ULL);
+        rngSeed(&rngs[i], sim->seed + g, 2);
+        coInit(&cos[i], gameCoroutine, &tables[i], 0);
+        asked[i] = coResume(&cos[i], NULL);     // runs until the first question
+    }
+    while (alive > 0)
+    {
+        for (long i = 0; i < n; i++)
+        {
+            if (cos[i].done) continue;
+            p = asked[i];
+            t = &tables[i];
+            kind = p->kind;
+            robot = sim->robots[p->player];
+            switch (kind)
+            {
+            case PROMPT_BID1: p->take = robot->bid1(t, p->player, &rngs[i]); break;
+            case PROMPT_BID2: p->take = robot->bid2(t, p->player, &p->color, &rngs[i]); break;
+            case PROMPT_CARD: p->card = robot->play(t, p->player, p->legal, &rngs[i]); break;
+            }
+            asked[i] = coResume(&cos[i], NULL);
+            if (kind == PROMPT_CARD && t->nbCardPli == 0) st.tricks++;
+            if (cos[i].done)
+            {
+                alive--;
+                st.games++;
+                st.deals += t->nbDeal;
+                coFree(&cos[i]);
+            }
+        }
+    }
+    free(tables);
+    free(rngs);
+    free(cos);
+    free(asked);
+    sim->stats = st;
+    return NULL;
+}
+
+// ==================== EXECUTORS (-x) ====================================
+
+/**
+ * @brief Result of an action on an executor: plays the robot of the player to act
+ * @details Runs on the table's executor thread. The robot's answer is posted like a
+ *          message from a remote player, the table only changes when it is applied.
+ */
+static void onAction(void *ctx, int exec, const table_t *t, const action_t *a, bool accepted){
+    execSim_t *sim = (execSim_t *)ctx;
+    simStats_t *st = &sim->locals[exec].stats;
+    rng_t *rng = &sim->locals[exec].rng;
+    table_t *view = (table_t *)t;   // robots only read the table
+    action_t r = {.table = a->table, .color = NONE};
+    const policy_t *robot;
+
+    if (t == NULL)
+    {
+        // Action late for a closed table: refused, the game was counted by its close
+        if (a->kind != ACT_CLOSE || !accepted) return;
+        checkZero(pthread_mutex_lock(&sim->lock), "pthread_mutex_lock");
+        if (--sim->remaining == 0) checkZero(pthread_cond_signal(&sim->done), "pthread_cond_signal");
+        checkZero(pthread_mutex_unlock(&sim->lock), "pthread_mutex_unlock");
+        return;
+    }
+    // Reply overtaken by the move played on timeout: the table goes on without it
+    if (!accepted && sim->timers && !a->automatic && a->kind != ACT_CREATE) return;
+    if (!accepted) fprintf(stderr, "Table %u : coup refusé (donne %016llx)\n", a->table, (unsigned long long)t->dealSeed);
+    if (a->kind == ACT_PLAY && t->nbCardPli == 0) st->tricks++;
+    st->timeouts += a->automatic;
+    if (!accepted || t->phase == PHASE_END)
+    {
+        st->games += accepted;
+        st->deals += t->nbDeal;
+        r.kind = ACT_CLOSE;
+        execPost(&sim->pool, &r);
+        return;
+    }
+    if (sim->absent && t->toAct == 0) return;
+    robot = sim->robots[t->toAct];
+    r.player = t->toAct;
+    switch (t->phase)
+    {
+    case PHASE_BID1:
+        r.kind = ACT_BID;
+        r.take = robot->bid1(view, r.player, rng);
+        break;
+    case PHASE_BID2:
+        r.kind = ACT_BID;
+        r.take = robot->bid2(view, r.player, &r.color, rng);
+        break;
+    default:
+        r.kind = ACT_PLAY;
+        r.card = robot->play(view, r.player, tableLegal(view), rng);
+        break;
+    }
+    execPost(&sim->pool, &r);
+}
+
+/**
+ * @brief Plays all the games at once on nbThreads executors
+ * @return Statistics summed over the executors
+ */
+static simStats_t simulateExecutors(int nbThreads, long nbGames, uint64_t seed, const policy_t *robots[PLAYERS_MAX],
+    int turnMs, bool absent){
+    execSim_t sim = {.remaining = nbGames, .absent = absent, .timers = turnMs > 0, .lock = PTHREAD_MUTEX_INITIALIZER, .done = PTHREAD_COND_INITIALIZER};
+    simStats_t tot = {0};
+
+    memcpy(sim.robots, robots, sizeof(sim.robots));
+    if ((sim.locals = aligned_alloc(64, nbThreads * sizeof(execLocal_t))) == NULL) { perror("aligned_alloc"); exit(EXIT_FAILURE); }
+    memset(sim.locals, 0, nbThreads * sizeof(execLocal_t));
+    for (int i = 0; i < nbThreads; i++) rngSeed(&sim.locals[i].rng, seed + i, 2);
+
+    execStart(&sim.pool, nbThreads, onAction, &sim);
+    if (turnMs > 0) execTurnTimers(&sim.pool, turnMs, turnMs, NULL);
+    for (long g = 0; g < nbGames; g++) execCreateTable(&sim.pool, seed + g * 0x9E3779B97F4A7C15ULL);
+    checkZero(pthread_mutex_lock(&sim.lock), "pthread_mutex_lock");
+    while (sim.remaining > 0) checkZero(pthread_cond_wait(&sim.done, &sim.lock), "pthread_cond_wait");
+    checkZero(pthread_mutex_unlock(&sim.lock), "pthread_mutex_unlock");
+    execStop(&sim.pool);
+
+    for (int i = 0; i < nbThreads; i++)
+    {
+        tot.games += sim.locals[i].stats.games;
+        tot.deals += sim.locals[i].stats.deals;
+        tot.tricks += sim.locals[i].stats.tricks;
+        tot.timeouts += sim.locals[i].stats.timeouts;
+    }
+    free(sim.locals);
+    return tot;
+}
+
+// ==================== MAIN ==============================================
+
+/**
+ * @brief Prints the usage and the available robots
+ */
+static void usage(const char *prog){
+    int nb;
+    const policy_t *p = listPolicies(&nb);
+
+    fprintf(stderr, "Usage : %s [-x [-d ms [-a]]|-c] [-t nbThreads] [-n nbGames] [-s seed] [-j bot0,bot1,bot2,bot3] [-o corpus]\n", prog);
+    fprintf(stderr, "Robots :");
+    for (int i = 0; i < nb; i++) fprintf(stderr, " %s", p[i].name);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses the robots of the 4 seats ("bot" for all seats, or "bot0,bot1,bot2,bot3")
+ */
+static void parseRobots(const char *prog, char *list, const policy_t *robots[PLAYERS_MAX]){
+    char *name = strtok(list, ",");
+
+    for (int i = 0; i < PLAYERS_MAX; i++)
+    {
+        if (name != NULL && (robots[i] = findPolicy(name)) == NULL) usage(prog);
+        if (name == NULL) robots[i] = robots[i - 1];
+        name = strtok(NULL, ",");
+    }
+}
+
+/**
+ * @brief Main entry point of the simulator
+ * @param[in] argc Number of command line arguments
+ * @param[in] argv Array of command line argument strings
+ * @return Exit status code
+ */
+int main(int argc, char *argv[])
+{
+    int nbThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    long nbGames = 1000;
+    uint64_t seed = time(NULL);
+    const policy_t *robots[PLAYERS_MAX] = {0};
+    FILE *corpus = NULL;
+    simThread_t *sims;
+    simStats_t tot = {0};
+    unsigned long long deb, ns;
+    double s;
+    bool executors = false, coroutines = false, absent = false;
+    int opt, turnMs = 0;
+
+    robots[0] = findPolicy("glouton");
+    for (int i = 1; i < PLAYERS_MAX; i++) robots[i] = robots[0];
+    while ((opt = getopt(argc, argv, "xcad:t:n:s:j:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'x': executors = true; break;
+        case 'c': coroutines = true; break;
+        case 'd': turnMs = atoi(optarg); break;
+        case 'a': absent = true; break;
+        case 't': nbThreads = atoi(optarg); break;
+        case 'n': nbGames = atol(optarg); break;
+        case 's': seed = strtoull(optarg, NULL, 0); break;
+        case 'j': parseRobots(argv[0], optarg, robots); break;
+        case 'o':
+            if ((corpus = fopen(optarg, "w")) == NULL) { perror(optarg); exit(EXIT_FAILURE); }
+            break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nbThreads <= 0) nbThreads = 1;
+    if (absent && (!executors || turnMs <= 0)) usage(argv[0]);
+    if ((sims = calloc(nbThreads, sizeof(simThread_t))) == NULL) { perror("calloc"); exit(EXIT_FAILURE); }
+
+    printf("%ld parties, %d threads, graine %llu, robots %s/%s/%s/%s\n", nbGames, nbThreads,
+        (unsigned long long)seed, robots[0]->name, robots[1]->name, robots[2]->name, robots[3]->name);
+
+    deb = nowNs();
+    if (executors)
+    {
+        tot = simulateExecutors(nbThreads, nbGames, seed, robots, turnMs, absent);
+        nbThreads = 0;  // no simulation thread
+    }
+    for (int i = 0; i < nbThreads; i++)
+    {
+        sims[i].firstGame = nbGames * i / nbThreads;
+        sims[i].nbGames = nbGames * (i + 1) / nbThreads - sims[i].firstGame;
+        sims[i].seed = seed;
+        sims[i].corpus = corpus;
+        memcpy(sims[i].robots, robots, sizeof(robots));
+        if (pthread_create(&sims[i].th, NULL, coroutines ? simulateCoroutines : simulate, &sims[i]) != 0) { perror("pthread_create"); exit(EXIT_FAILURE); }
+    }
+    for (int i = 0; i < nbThreads; i++)
+    {
+        pthread_join(sims[i].th, NULL);
+        tot.games += sims[i].stats.games;
+        tot.deals += sims[i].stats.deals;
+        tot.tricks += sims[i].stats.tricks;
+        tot.passes += sims[i].stats.passes;
+        tot.nsDeal += sims[i].stats.nsDeal;
+        tot.nsBid += sims[i].stats.nsBid;
+        tot.nsPlay += sims[i].stats.nsPlay;
+    }
+    ns = nowNs() - deb;
+    s = ns / 1e9;
+    if (corpus != NULL) fclose(corpus);
+
+    printf("%ld parties, %ld donnes (%ld passées), %ld plis en %.3f s\n", tot.games, tot.deals, tot.passes, tot.tricks, s);
+    printf("%.0f parties/s, %.0f donnes/s, %.0f plis/s\n", tot.games / s, tot.deals / s, tot.tricks / s);
+    if (turnMs > 0) printf("%ld coups joués à l'échéance\n", tot.timeouts);
+    if (tot.deals > 0 && !executors && !coroutines)
+        printf("par donne : distribution %llu ns, enchères %llu ns, jeu %llu ns\n",
+            tot.nsDeal / tot.deals, tot.nsBid / tot.deals, tot.nsPlay / tot.deals);
+    free(sims);
+    return (tot.games == nbGames) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,49 +1,63 @@
 #include "../include/socketEnregistrement.h"
 
-void * threadLogic(void * arg){
-	printf("Réussi thread");
-
-	char msg[1];
-	socket_t * sd = (socket_t * ) arg;
+/**
+ *	\fn			void traiterMessEvt(connexion_t *cnx, char *msg, int len)
+ *	\brief		Traitement d'un message complet (mode événementiel ou pool de travailleurs)
+ */
+void traiterMessEvt(connexion_t *cnx, char *msg, int len){
 	reponse_t rep;
 	requete_t req;
-	// sockEcoute est une variable externe
-	while(read(sd->fd, msg, 1) > 0){
-		//aquisition req clt
-		//mise en forme
-		//si fin dialogue alors break
-		recevoir(sd,(generic)&rep,(pFct)str2rep);
-		fprintf(stderr,REQ_STR_OUT"\n",rep.idRep,rep.verbRep,rep.optRep);
-		req = traiterRegister(&rep, sd);
-		envoyer(sd, (generic)&req, (pFct)req2str);
-		fprintf(stderr,REQ_STR_OUT"\n",req.idReq,req.verbReq,req.optReq);
-
 
+	codecSocket(&cnx->sock)->buf2rep(msg, len, &rep);
+	#ifdef DEBUG
+		fprintf(stderr,REQ_STR_OUT"\n",rep.idRep,rep.verbRep,rep.optRep);
+	#endif
+	req = traiterRegister(&rep, &cnx->sock);
+	// 302 : deconnecterUser() a déjà fermé la socket
+	if(cnx->sock.fd == -1){
+		cnx->fermee = 1;
+		return;
 	}
-		CHECK(close(sd->fd),"-- PB close() --");
+	// Un client parti ne fait pas tomber le serveur : la boucle ferme la connexion morte
+	if(req.idReq != 0) envoyerSts(&cnx->sock, (generic)&req, codecSocket(&cnx->sock)->req2buf);
+}
 
+/**
+ *	\fn			void fermerCnxEvt(connexion_t *cnx)
+ *	\brief		Déconnexion d'un client (mode événementiel ou pool de travailleurs)
+ */
+void fermerCnxEvt(connexion_t *cnx){
+	int index = userSocket(&cnx->sock);
+	if(index != -1) deconnecterUser(index);
+	else CHECK(close(cnx->sock.fd),"-- PB close() --");
 }
 
-int main(){
-	socket_t sa;
+/**
+ *	\fn			void sonderCnxEvt(connexion_t *cnx)
+ *	\brief		Message de vie envoyé à un client muet depuis DELAI_SONDE_MS
+ */
+void sonderCnxEvt(connexion_t *cnx){
+	sonderClient(&cnx->sock);
+}
+
+int main(int argc, char **argv){
 	socket_t sockEcoute;
+	int inactivite = DELAI_INACTIVITE_MS;
 
-    pthread_t th;
-    pthread_attr_t attr;
+	// -i S (en dernier) : client fermé après S secondes de silence, sondé à mi-parcours
+	if(argc > 2 && strcmp(argv[argc-2], "-i") == 0){
+		inactivite = atoi(argv[argc-1]) * 1000;
+		argc -= 2;
+	}
+	reglerInactivite(inactivite < DELAI_INACTIVITE_MS ? inactivite / 2 : DELAI_SONDE_MS, inactivite, sonderCnxEvt);
+	initTraitements();
+	lireUsers();
 	sockEcoute = creerSocketEcoute(IP_HOST, PORT);
-	while(1){
-		sa=accepterClt(sockEcoute);
-	CHECK_ZERO(pthread_attr_init(&attr), "T ERROR main 1");
-    CHECK_ZERO(pthread_attr_setdetachstate(&attr,
-            PTHREAD_CREATE_DETACHED),
-             "T ERROR main 2");
-	CHECK_ZERO(pthread_create(&th, &attr, 
-                (pFctThread) threadLogic,
-                (void*) &sa), 
-                "T ERROR main 3");
 
-		printf("Réussi main");
+	// Mode événementiel : toutes les connexions multiplexées sur quelques threads
+	if(argc > 1 && strcmp(argv[1], "-e") == 0){
+		lancerBoucles(sockEcoute, argc > 2 ? atoi(argv[2]) : 0, traiterMessEvt, fermerCnxEvt);
 	}
-	
-    
-}
\ No newline at end of file
+	// Par défaut : pool fixe de travailleurs (-p N : N travailleurs), un par cœur
+	lancerPool(sockEcoute, (argc > 2 && strcmp(argv[1], "-p") == 0) ? atoi(argv[2]) : 0, traiterMessEvt, fermerCnxEvt);
+}
@@ -1,7 +1,13 @@
 #include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <arpa/inet.h>
 #include "../include/libRepReq.h"
 #include "../include/users.h"
+#include "../include/parties.h"
 /*
 *****************************************************************************************
  *	\note		D E F I N I T I O N   DES   M A C R O S
@@ -27,108 +33,763 @@
 
 
 
-users_t users;
+/**
+ *	\def		TRACE_USERS(cde)
+ *	\brief		Affiche la table des utilisateurs après une modification (mode DEBUG seulement :
+ *				l'affichage parcourt toute la table)
+ */
+#ifdef DEBUG
+#define TRACE_USERS(cde) afficherUsers(cde)
+#else
+#define TRACE_USERS(cde)
+#endif
+/**
+ *	\def		PATIENTER()
+ *	\brief		Attente active d'un lecteur pendant l'écriture d'une partition : instruction pause
+ *				sur x86, simple barrière du compilateur ailleurs (la version est relue à chaque tour)
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define PATIENTER()	__builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define PATIENTER()	__asm__ __volatile__("yield" ::: "memory")
+#else
+#define PATIENTER()	__asm__ __volatile__("" ::: "memory")
+#endif
+/**
+ *	\def		CAPACITE_INDEX
+ *	\brief		Nombre initial de cases d'une table d'index (puissance de 2)
+ */
+#define CAPACITE_INDEX	64
+/**
+ *	\def		INDEX_NOM, INDEX_SOCKET
+ *	\brief		Clé d'un index : nom de l'utilisateur ou adresse de sa socket de dialogue
+ */
+#define INDEX_NOM		0
+#define INDEX_SOCKET	1
+/**
+ *	\def		OP_CREER, OP_SUPPRIMER
+ *	\brief		Modifications enregistrées dans le journal
+ */
+#define OP_CREER		1
+#define OP_SUPPRIMER	2
+/**
+ *	\def		MAGIQUE_USERS, VERSION_USERS
+ *	\brief		Signature et version du format de l'instantané
+ */
+#define MAGIQUE_USERS	"USRS"
+#define VERSION_USERS	1
+/*
+*****************************************************************************************
+ *	\noop		S T R U C T U R E S   DES   F I C H I E R S
+ */
+/**
+ *	\struct		enteteUsers_t
+ *	\brief		En-tête de l'instantané, suivi de nb enregistrements enregUser_t
+ */
+typedef struct {
+	char magique[4];		/**< MAGIQUE_USERS */
+	uint32_t version;		/**< VERSION_USERS */
+	uint32_t tailleEnreg;	/**< sizeof(enregUser_t) */
+	uint32_t nb;			/**< Nombre d'enregistrements */
+} enteteUsers_t;
+/**
+ *	\struct		enregUser_t
+ *	\brief		Utilisateur de l'instantané : uniquement des données, aucun pointeur
+ */
+typedef struct {
+	char name[MAX_NAME];	/**< Nom (terminé par \0) */
+} enregUser_t;
+/**
+ *	\struct		enregAncien_t
+ *	\brief		Utilisateur de FICHIER_USERS dans le format de la première version (sans en-tête) :
+ *				image mémoire de l'ancien user_t, seul le nom est repris
+ */
+typedef struct {
+	char name[MAX_NAME];	/**< Nom (terminé par \0) */
+	void *sDial;			/**< Pointeur, sans signification sur disque */
+	int indDest;			/**< Ignoré */
+	struct {
+		void *list[4];
+		int nbJoueurs;
+	} party;				/**< Ignoré */
+} enregAncien_t;
+/**
+ *	\struct		enregJournal_t
+ *	\brief		Modification du journal, la somme de contrôle détecte un enregistrement incomplet
+ */
+typedef struct {
+	uint32_t op;			/**< OP_CREER ou OP_SUPPRIMER */
+	uint32_t somme;			/**< Somme de contrôle de l'enregistrement (somme = 0 pendant le calcul) */
+	uint64_t numero;		/**< Numéro d'ordre de la modification */
+	char name[MAX_NAME];	/**< Nom de l'utilisateur */
+} enregJournal_t;
+/**
+ *	\struct		journal_t
+ *	\brief		Journal des modifications : les écrivains ajoutent au tampon, un thread l'écrit
+ */
+typedef struct {
+	int fd;					/**< Journal ouvert, -1 tant que lireUsers() n'a pas été appelée */
+	pthread_mutex_t verrou;	/**< Protège le tampon et les compteurs */
+	pthread_cond_t aEcrire;	/**< Signalée quand le tampon reçoit un enregistrement */
+	pthread_cond_t ecrit;	/**< Signalée après chaque lot écrit et chaque compactage */
+	enregJournal_t *tampon;	/**< Enregistrements en attente d'écriture */
+	int nb, capacite;		/**< Taille et capacité du tampon */
+	uint64_t numero;		/**< Numéro de la dernière modification */
+	uint64_t numeroDurable;	/**< Numéro de la dernière modification écrite sur disque */
+	long nbEnreg;			/**< Enregistrements dans le journal sur disque */
+	unsigned int demandes;	/**< Compactages demandés */
+	unsigned int compactages;	/**< Compactages effectués */
+	int ancienConserve;		/**< 1 si JOURNAL_USERS.old attend un instantané complet */
+} journal_t;
+
+
+
+static journal_t journal = {.fd = -1, .verrou = PTHREAD_MUTEX_INITIALIZER,
+	.aEcrire = PTHREAD_COND_INITIALIZER, .ecrit = PTHREAD_COND_INITIALIZER};
+static void journaliser(int op, const char *nom);
+
+users_t users = {.premierLibre = -1, .verrou = PTHREAD_MUTEX_INITIALIZER,
+	.parNom = {[0 ... NB_SHARDS_USERS-1] = {.verrou = PTHREAD_MUTEX_INITIALIZER}},
+	.parSocket = {[0 ... NB_SHARDS_USERS-1] = {.verrou = PTHREAD_MUTEX_INITIALIZER}}};
+
+/**
+ *	\fn			static user_t *userAt(int indUser)
+ *	\brief		Utilisateur d'indice indUser (bloc indUser / TAILLE_BLOC_USERS)
+ */
+static inline user_t *userAt(int indUser) {
+	return &users.blocs[indUser / TAILLE_BLOC_USERS][indUser % TAILLE_BLOC_USERS];
+}
+/**
+ *	\fn			static unsigned int hacher(int type, const void *cle)
+ *	\brief		Hachage FNV-1a du nom, ou mélange de l'adresse de la socket
+ */
+static unsigned int hacher(int type, const void *cle) {
+	unsigned int h = 2166136261u;
+	if (type == INDEX_SOCKET) {
+		unsigned long long a = (unsigned long long)(uintptr_t)cle * 0x9E3779B97F4A7C15ULL;
+		return a >> 32;
+	}
+	for (const unsigned char *c = cle; *c; c++) h = (h ^ *c) * 16777619u;
+	return h;
+}
+/**
+ *	\fn			static shardUsers_t *shard(int type, unsigned int h)
+ *	\brief		Partition de l'index type contenant les clés de hachage h (bits de poids fort)
+ */
+static shardUsers_t *shard(int type, unsigned int h) {
+	shardUsers_t *shards = (type == INDEX_NOM) ? users.parNom : users.parSocket;
+	return &shards[h >> (32 - __builtin_ctz(NB_SHARDS_USERS))];
+}
+/**
+ *	\fn			static const void *cleUser(int type, int indUser)
+ *	\brief		Clé d'un utilisateur dans l'index type
+ */
+static const void *cleUser(int type, int indUser) {
+	return (type == INDEX_NOM) ? (const void *)userAt(indUser)->name : (const void *)userAt(indUser)->sDial;
+}
+/**
+ *	\fn			static int memeCle(int type, const void *cle, int indUser)
+ *	\brief		Vrai si l'utilisateur a la clé cle
+ */
+static int memeCle(int type, const void *cle, int indUser) {
+	if (type == INDEX_SOCKET) return userAt(indUser)->sDial == cle;
+	return strcmp(userAt(indUser)->name, cle) == 0;
+}
+/**
+ *	\fn			static int sonder(const tableIndex_t *t, int type, const void *cle, unsigned int h, unsigned int *pos)
+ *	\brief		Sonde la table jusqu'à la clé ou une case vide
+ *	\param 		pos : case trouvée, ou case vide où insérer la clé
+ *	\return		Indice de l'utilisateur, -1 si la clé est absente
+ *	\note		Le parcours est borné : un lecteur concurrent peut voir la table en cours de modification
+ */
+static int sonder(const tableIndex_t *t, int type, const void *cle, unsigned int h, unsigned int *pos) {
+	unsigned int masque, i, n;
+	int c;
+
+	if (t == NULL) return -1;
+	masque = t->capacite - 1;
+	for (i = h & masque, n = 0; n < t->capacite; i = (i + 1) & masque, n++) {
+		if ((c = __atomic_load_n(&t->cases[i], __ATOMIC_RELAXED)) == 0) break;
+		if (memeCle(type, cle, c - 1)) {
+			if (pos != NULL) *pos = i;
+			return c - 1;
+		}
+	}
+	if (pos != NULL) *pos = i;
+	return -1;
+}
+/**
+ *	\fn			static int lireIndex(int type, const void *cle)
+ *	\brief		Recherche sans verrou : recommence si un écrivain a modifié la partition entre-temps
+ */
+static int lireIndex(int type, const void *cle) {
+	unsigned int h = hacher(type, cle), version;
+	shardUsers_t *sh = shard(type, h);
+	int index;
+
+	do {
+		while ((version = __atomic_load_n(&sh->version, __ATOMIC_ACQUIRE)) & 1) PATIENTER();
+		index = sonder(__atomic_load_n(&sh->table, __ATOMIC_ACQUIRE), type, cle, h, NULL);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n(&sh->version, __ATOMIC_RELAXED) != version);
+	return index;
+}
+/**
+ *	\fn			static void debutEcriture(shardUsers_t *sh), static void finEcriture(shardUsers_t *sh)
+ *	\brief		Section d'écriture d'une partition : mutex entre écrivains, version impaire pour les lecteurs
+ */
+static void debutEcriture(shardUsers_t *sh) {
+	CHECK_ZERO(pthread_mutex_lock(&sh->verrou), "pthread_mutex_lock");
+	__atomic_store_n(&sh->version, sh->version + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+static void finEcriture(shardUsers_t *sh) {
+	__atomic_store_n(&sh->version, sh->version + 1, __ATOMIC_RELEASE);
+	CHECK_ZERO(pthread_mutex_unlock(&sh->verrou), "pthread_mutex_unlock");
+}
+/**
+ *	\fn			static void indexer(shardUsers_t *sh, int type, int indUser)
+ *	\brief		Ajoute un utilisateur à la partition (en section d'écriture)
+ *	\note		La table double de taille au-delà d'1/2 de remplissage ; la nouvelle table est
+ *				remplie avant d'être publiée
+ */
+static void indexer(shardUsers_t *sh, int type, int indUser) {
+	tableIndex_t *t = sh->table, *nouvelle;
+	unsigned int pos, capacite;
+
+	if (t == NULL || 2 * (t->nb + 1) > t->capacite) {
+		capacite = t ? 2 * t->capacite : CAPACITE_INDEX;
+		CHECK_NULL(nouvelle = calloc(1, sizeof(tableIndex_t) + capacite * sizeof(int)), "--calloc()--");
+		nouvelle->capacite = capacite;
+		for (unsigned int i = 0; t != NULL && i < t->capacite; i++)
+			if (t->cases[i] != 0) {
+				sonder(nouvelle, type, cleUser(type, t->cases[i] - 1), hacher(type, cleUser(type, t->cases[i] - 1)), &pos);
+				nouvelle->cases[pos] = t->cases[i];
+				nouvelle->nb++;
+			}
+		__atomic_store_n(&sh->table, nouvelle, __ATOMIC_RELEASE);
+		t = nouvelle;
+	}
+	sonder(t, type, cleUser(type, indUser), hacher(type, cleUser(type, indUser)), &pos);
+	__atomic_store_n(&t->cases[pos], indUser + 1, __ATOMIC_RELAXED);
+	t->nb++;
+}
+/**
+ *	\fn			static void desindexer(shardUsers_t *sh, int type, int indUser)
+ *	\brief		Retire un utilisateur de la partition (en section d'écriture)
+ *	\note		Suppression par décalage arrière : aucune case « supprimée » ne ralentit les recherches
+ */
+static void desindexer(shardUsers_t *sh, int type, int indUser) {
+	tableIndex_t *t = sh->table;
+	unsigned int masque, trou, i, origine;
+
+	if (sonder(t, type, cleUser(type, indUser), hacher(type, cleUser(type, indUser)), &trou) != indUser) return;
+	masque = t->capacite - 1;
+	__atomic_store_n(&t->cases[trou], 0, __ATOMIC_RELAXED);
+	t->nb--;
+	// Remonter les clés suivantes dont la case d'origine ne se trouve pas entre le trou et elles
+	for (i = (trou + 1) & masque; t->cases[i] != 0; i = (i + 1) & masque) {
+		origine = hacher(type, cleUser(type, t->cases[i] - 1)) & masque;
+		if (((i - origine) & masque) >= ((i - trou) & masque)) {
+			__atomic_store_n(&t->cases[trou], t->cases[i], __ATOMIC_RELAXED);
+			__atomic_store_n(&t->cases[i], 0, __ATOMIC_RELAXED);
+			trou = i;
+		}
+	}
+}
+/**
+ *	\fn			static void changerSocket(int indUser, socket_t *sDial)
+ *	\brief		Associe une socket de dialogue à un utilisateur en tenant l'index à jour
+ */
+static void changerSocket(int indUser, socket_t *sDial) {
+	user_t *u = userAt(indUser);
+	shardUsers_t *sh;
+
+	if (u->sDial == sDial) return;
+	if (u->sDial != NULL) {
+		sh = shard(INDEX_SOCKET, hacher(INDEX_SOCKET, u->sDial));
+		debutEcriture(sh);
+		desindexer(sh, INDEX_SOCKET, indUser);
+		u->sDial = NULL;
+		finEcriture(sh);
+	}
+	if (sDial != NULL) {
+		sh = shard(INDEX_SOCKET, hacher(INDEX_SOCKET, sDial));
+		debutEcriture(sh);
+		u->sDial = sDial;
+		indexer(sh, INDEX_SOCKET, indUser);
+		finEcriture(sh);
+	}
+}
+/**
+ *	\fn			static int allouerUser(void)
+ *	\brief		Réserve un emplacement : emplacement libéré, sinon suivant (nouveau bloc si besoin)
+ *	\return		Indice de l'emplacement, -1 si la table est pleine
+ */
+static int allouerUser(void) {
+	int index = -1;
+
+	CHECK_ZERO(pthread_mutex_lock(&users.verrou), "pthread_mutex_lock");
+	if (users.premierLibre != -1) {
+		index = users.premierLibre;
+		users.premierLibre = userAt(index)->suivantLibre;
+	}
+	else if (users.nbUsers < MAX_USERS) {
+		if (users.nbUsers == users.nbBlocs * TAILLE_BLOC_USERS) {
+			CHECK_NULL(users.blocs[users.nbBlocs] = calloc(TAILLE_BLOC_USERS, sizeof(user_t)), "--calloc()--");
+			users.nbBlocs++;
+		}
+		index = users.nbUsers;
+		// Le bloc est publié avant que l'indice ne devienne visible des parcours
+		__atomic_store_n(&users.nbUsers, users.nbUsers + 1, __ATOMIC_RELEASE);
+	}
+	CHECK_ZERO(pthread_mutex_unlock(&users.verrou), "pthread_mutex_unlock");
+	return index;
+}
+/**
+ *	\fn			static int creerUserPartition(shardUsers_t *sh, name_t nom)
+ *	\brief		Crée un utilisateur et l'ajoute à l'index par nom (en section d'écriture de sh)
+ */
+static int creerUserPartition(shardUsers_t *sh, name_t nom) {
+	int index;
+	user_t *u;
+
+	if ((index = allouerUser()) == -1) return -1;
+	u = userAt(index);
+	memset(u, 0, sizeof(user_t));
+	strncpy(u->name, nom, MAX_NAME-1);
+	u->indDest=-1;
+	u->partie=PARTIE_NULLE;
+	indexer(sh, INDEX_NOM, index);
+	journaliser(OP_CREER, u->name);
+	return index;
+}
 
 int afficherUsers(char *cde) {
-	printf("[%s] Liste des users [%d]\n", cde, users.nbUsers);	
-	for (int i=0; i < users.nbUsers; i++)
-		if (users.tab[i].sDial != NULL)
+	printf("[%s] Liste des users [%d]\n", cde, nbUsers());	
+	for (int i=0; i < nbUsers(); i++) {
+		user_t *u = userAt(i);
+		if (u->name[0] == '\0') continue;
+		if (u->sDial != NULL)
 			printf("\tUser [%d:%s], Socket [%d], IP [%s], Dest [%i]\n",
-				i,users.tab[i].name, users.tab[i].sDial->fd,
-				inet_ntoa((users.tab[i].sDial->addrDst).sin_addr),users.tab[i].indDest);
+				i,u->name, u->sDial->fd,
+				inet_ntoa((u->sDial->addrDst).sin_addr),u->indDest);
 		else
 			printf("\tUser [%d:%s], Socket [-1], IP [0.0.0.0], Dest [%i]\n",
-				i,users.tab[i].name,users.tab[i].indDest);
+				i,u->name,u->indDest);
+	}
+	return 0;
 }
+int nbUsers(void) { return __atomic_load_n(&users.nbUsers, __ATOMIC_ACQUIRE); }
 int trouverUser(name_t nom) {
-	int i=0;
-	for (i=0; i < MAX_USERS; i++)
-		if (strcmp(nom, users.tab[i].name)==0) return i;
-	return -1;
+	if (nom == NULL || nom[0] == '\0') return -1;
+	return lireIndex(INDEX_NOM, nom);
 }
 int creerUser(name_t nom, socket_t *sDial) {
-	if (users.nbUsers == MAX_USERS) return -1;
-	strncpy(users.tab[users.nbUsers].name, nom, MAX_NAME-1);
-	if (strlen(nom)==MAX_NAME-1) users.tab[users.nbUsers].name[MAX_NAME-1]='\0';
-	users.tab[users.nbUsers].sDial=sDial;
-	users.tab[users.nbUsers].indDest=-1;
-	users.nbUsers++;
+	shardUsers_t *sh = shard(INDEX_NOM, hacher(INDEX_NOM, nom));
+	int index;
+
+	debutEcriture(sh);
+	index = creerUserPartition(sh, nom);
+	finEcriture(sh);
+	if (index == -1) return -1;
+	changerSocket(index, sDial);
 	//
-	afficherUsers("créer");
-	return users.nbUsers-1;
+	TRACE_USERS("créer");
+	return index;
+}
+void supprimerUser(int indUser) {
+	user_t *u = userAt(indUser);
+	shardUsers_t *sh;
+
+	if (u->name[0] == '\0') return;
+	quitterPartie(indUser);
+	sh = shard(INDEX_NOM, hacher(INDEX_NOM, u->name));
+	debutEcriture(sh);
+	changerSocket(indUser, NULL);
+	desindexer(sh, INDEX_NOM, indUser);
+	journaliser(OP_SUPPRIMER, u->name);
+	finEcriture(sh);
+	// Hors de l'index : l'emplacement peut être effacé puis réutilisé
+	u->name[0] = '\0';
+	CHECK_ZERO(pthread_mutex_lock(&users.verrou), "pthread_mutex_lock");
+	u->suivantLibre = users.premierLibre;
+	users.premierLibre = indUser;
+	CHECK_ZERO(pthread_mutex_unlock(&users.verrou), "pthread_mutex_unlock");
+}
+int userSocket(socket_t *sDial) {
+	if (sDial == NULL) return -1;
+	return lireIndex(INDEX_SOCKET, sDial);
+}
+int enregistrerUser(name_t nom, socket_t *sDial) {
+	shardUsers_t *sh = shard(INDEX_NOM, hacher(INDEX_NOM, nom));
+	int index;
+
+	// Recherche, création et association sous le même verrou : deux connexions du même nom
+	// créent un seul utilisateur et une seule obtient sa socket (verrou du nom, puis de la socket)
+	debutEcriture(sh);
+	if ((index = sonder(sh->table, INDEX_NOM, nom, hacher(INDEX_NOM, nom), NULL)) == -1)
+		index = creerUserPartition(sh, nom);
+	else {
+		// Utilisateur connecté sur une autre socket : identité refusée. La socket d'une autre
+		// connexion n'est jamais lue, elle peut être libérée à tout moment ; deconnecterUser()
+		// la détache sous ce même verrou avant de la fermer
+		if (userAt(index)->sDial != NULL && userAt(index)->sDial != sDial) index = -1;
+		else userAt(index)->indDest=-1;
+	}
+	if (index != -1) changerSocket(index, sDial);
+	finEcriture(sh);
+	return index;
 }
 int identifierUser(socket_t *sDial) {
 	requete_t req;
 	int index = -1;
-	recevoir(sDial, &req, (pFct)str2req);
-	if (req.idReq==300)
-		if ((index=trouverUser(req.optReq))==-1) index=creerUser(req.optReq, sDial);
-		else { users.tab[index].sDial=sDial; users.tab[index].indDest==-1; }
+	// Socket déjà associée à un utilisateur : pas de nouvelle identification
+	if ((index=userSocket(sDial))!=-1) return index;
+	// Client parti avant de s'identifier : seule sa socket est fermée
+	if (recevoirSts(sDial, &req, (pFctDeSerial)str2req)==0 && req.idReq==300) index=enregistrerUser(req.optReq, sDial);
 	if (index==-1) CHECK(close(sDial->fd),"--close()--");
 	//
-	afficherUsers("identifier");
+	TRACE_USERS("identifier");
 	return index;
 } 
 void deconnecterUser(int indUser) {
-	printf("Déconnexion : User [%s], Socket [%d], IP [%s]\n",users.tab[indUser].name,
-		users.tab[indUser].sDial->fd, inet_ntoa((users.tab[indUser].sDial->addrDst).sin_addr));
-	CHECK(close(((socket_t *)users.tab[indUser].sDial)->fd),"--close()--");
-	users.tab[indUser].sDial = NULL;
-	users.tab[indUser].indDest = -1;
+	user_t *u = userAt(indUser);
+	socket_t *sDial = u->sDial;
+	shardUsers_t *sh = shard(INDEX_NOM, hacher(INDEX_NOM, u->name));
+
+	printf("Déconnexion : User [%s], Socket [%d], IP [%s]\n",u->name,
+		sDial->fd, inet_ntoa((sDial->addrDst).sin_addr));
+	// Détachée sous le verrou du nom avant d'être fermée : enregistrerUser() ne voit plus
+	// qu'un utilisateur déconnecté
+	debutEcriture(sh);
+	changerSocket(indUser, NULL);
+	u->indDest = -1;
+	finEcriture(sh);
+	fermerFileEmission(sDial);	// plus aucun envoi sur le descripteur fermé
+	CHECK(close(sDial->fd),"--close()--");
+	sDial->fd = -1;	// socket fermée : l'appelant la libère
+	quitterPartie(indUser);
 	//
-	afficherUsers("déconnecter");
+	TRACE_USERS("déconnecter");
 }
 
 void modifierDest(int indUser, name_t destName) {
-	users.tab[indUser].indDest = trouverUser(destName);
+	userAt(indUser)->indDest = trouverUser(destName);
 	//
-	afficherUsers("modifier");
+	TRACE_USERS("modifier");
 	//return indDest;
 }
-int indiceDest(int indUser) { return users.tab[indUser].indDest; }
+int indiceDest(int indUser) { return userAt(indUser)->indDest; }
+
+hPartie_t partieUser(int indUser) {
+	hPartie_t partie = PARTIE_NULLE;
+	if (indUser!=-1) __atomic_load(&userAt(indUser)->partie, &partie, __ATOMIC_RELAXED);
+	return partie;
+}
+void modifierPartie(int indUser, hPartie_t partie) {
+	__atomic_store(&userAt(indUser)->partie, &partie, __ATOMIC_RELAXED);
+}
 
 char * nameUser(int indUser) {
 	if (indUser==-1) return NULL;
-	else return users.tab[indUser].name;
+	else return userAt(indUser)->name;
 }
 socket_t *socketUser(int indUser) {
 	if (indUser==-1) return NULL;
-	else return users.tab[indUser].sDial;
+	else return userAt(indUser)->sDial;
 }
 
-void lireUsers(void) {
-	FILE *fp;
-	CHECK_NULL(fp=fopen("users.dat", "r"), "--fopen()--");
-	CHECK(users.nbUsers=fread(users.tab, sizeof(user_t), MAX_USERS, fp),"--fread()--");
-	CHECK(fclose(fp),"--fclose()--");
+/*
+*****************************************************************************************
+ *	\noop		P E R S I S T A N C E   :   J O U R N A L   E T   I N S T A N T A N E
+ */
+/**
+ *	\fn			static uint32_t sommeControle(const void *donnees, size_t taille)
+ *	\brief		Somme de contrôle FNV-1a d'un enregistrement
+ */
+static uint32_t sommeControle(const void *donnees, size_t taille) {
+	uint32_t h = 2166136261u;
+	for (const unsigned char *c = donnees; taille--; c++) h = (h ^ *c) * 16777619u;
+	return h;
 }
-void ecrireUsers(void) {
-	FILE *fp;
-	CHECK_NULL(fp=fopen("users.dat", "w"), "--fopen()--");
-	CHECK(fwrite(users.tab, sizeof(user_t), users.nbUsers, fp),"--fread()--");
-	CHECK(fclose(fp),"--fclose()--");	
+/**
+ *	\fn			static void synchroniserRepertoire(void)
+ *	\brief		Rend durables les créations/renommages de fichiers du répertoire courant
+ */
+static void synchroniserRepertoire(void) {
+	int fd;
+	CHECK(fd = open(".", O_RDONLY), "--open()--");
+	CHECK(fsync(fd), "--fsync()--");
+	CHECK(close(fd), "--close()--");
 }
+/**
+ *	\fn			static void journaliser(int op, const char *nom)
+ *	\brief		Ajoute une modification au tampon du journal (sans attendre l'écriture)
+ *	\note		Appelée sous le verrou de la partition du nom : les modifications d'un même
+ *				nom sont numérotées dans l'ordre où elles ont été faites
+ */
+static void journaliser(int op, const char *nom) {
+	enregJournal_t *e;
 
+	if (__atomic_load_n(&journal.fd, __ATOMIC_ACQUIRE) == -1) return;
+	CHECK_ZERO(pthread_mutex_lock(&journal.verrou), "pthread_mutex_lock");
+	if (journal.nb == journal.capacite) {
+		journal.capacite = journal.capacite ? 2 * journal.capacite : 256;
+		CHECK_NULL(journal.tampon = realloc(journal.tampon, journal.capacite * sizeof(enregJournal_t)), "--realloc()--");
+	}
+	e = &journal.tampon[journal.nb++];
+	memset(e, 0, sizeof(enregJournal_t));
+	e->op = op;
+	e->numero = ++journal.numero;
+	strncpy(e->name, nom, MAX_NAME-1);
+	e->somme = sommeControle(e, sizeof(enregJournal_t));
+	CHECK_ZERO(pthread_cond_signal(&journal.aEcrire), "pthread_cond_signal");
+	CHECK_ZERO(pthread_mutex_unlock(&journal.verrou), "pthread_mutex_unlock");
+}
+/**
+ *	\fn			static int ecrireInstantane(void)
+ *	\brief		Écrit l'état courant dans un fichier temporaire puis le renomme en FICHIER_USERS
+ *	\note		Sans verrou : un nom copié pendant sa modification est écarté car l'index ne
+ *				le rattache pas à cet emplacement, la modification est de toute façon au journal
+ *	\return		0, -1 si l'instantané n'a pas pu être écrit en entier (disque plein...) :
+ *				FICHIER_USERS n'est alors pas modifié
+ */
+static int ecrireInstantane(void) {
+	enteteUsers_t entete = {MAGIQUE_USERS, VERSION_USERS, sizeof(enregUser_t), 0};
+	enregUser_t enreg;
+	FILE *fp;
+	int ok;
 
-
-
-
-//TODO
-void creerPartie(socket_t * sDial){
-	user_t host = users.tab[identifierUser(sDial)];
-	host.party.list[0] = &host;
-	host.party.nbJoueurs = 1;
+	if ((fp = fopen(FICHIER_USERS ".tmp", "w")) == NULL) {
+		perror("--fopen()--");
+		return -1;
+	}
+	ok = fwrite(&entete, sizeof(entete), 1, fp) == 1;
+	for (int i = 0; ok && i < nbUsers(); i++) {
+		memset(&enreg, 0, sizeof(enreg));
+		strncpy(enreg.name, userAt(i)->name, MAX_NAME-1);
+		if (enreg.name[0] == '\0' || trouverUser(enreg.name) != i) continue;
+		ok = fwrite(&enreg, sizeof(enreg), 1, fp) == 1;
+		entete.nb++;
+	}
+	ok = ok && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&entete, sizeof(entete), 1, fp) == 1
+		&& fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+	if (fclose(fp) != 0) ok = 0;
+	if (!ok || rename(FICHIER_USERS ".tmp", FICHIER_USERS) == -1) {
+		perror("--" FICHIER_USERS " : instantané abandonné--");
+		unlink(FICHIER_USERS ".tmp");
+		return -1;
+	}
+	synchroniserRepertoire();
+	return 0;
 }
+/**
+ *	\fn			static void compacter(void)
+ *	\brief		Repart d'un journal vide et réécrit l'instantané (thread du journal, verrou pris)
+ *	\note		Le journal est d'abord mis de côté : si l'instantané n'est pas terminé, le
+ *				rejeu de l'ancien journal puis du nouveau redonne l'état exact. Rejouer une
+ *				modification déjà présente dans l'instantané est sans effet. L'ancien journal
+ *				n'est supprimé qu'après un instantané complet ; tant qu'il attend, le journal
+ *				courant n'est plus mis de côté (il écraserait l'ancien) et l'instantané est
+ *				retenté après MAX_JOURNAL_USERS nouvelles modifications
+ */
+static void compacter(void) {
+	int sts;
 
-int isFull(int idUser){
-	return users.tab[idUser].party.nbJoueurs >=4;
+	if (!journal.ancienConserve) {
+		CHECK(rename(JOURNAL_USERS, JOURNAL_USERS ".old"), "--rename()--");
+		CHECK(close(journal.fd), "--close()--");
+		CHECK(journal.fd = open(JOURNAL_USERS, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644), "--open()--");
+		synchroniserRepertoire();
+	}
+	journal.nbEnreg = 0;
+	CHECK_ZERO(pthread_mutex_unlock(&journal.verrou), "pthread_mutex_unlock");
+	if ((sts = ecrireInstantane()) == 0) CHECK(unlink(JOURNAL_USERS ".old"), "--unlink()--");
+	CHECK_ZERO(pthread_mutex_lock(&journal.verrou), "pthread_mutex_lock");
+	journal.ancienConserve = (sts == -1);
 }
+/**
+ *	\fn			static void *ecrireJournal(void *arg)
+ *	\brief		Thread du journal : écrit le tampon par lots, un fdatasync par lot
+ *	\note		Le tampon rempli pendant DELAI_JOURNAL_MS est échangé avec le lot
+ *				précédent : les écrivains n'attendent jamais le disque
+ */
+static void *ecrireJournal(void *arg) {
+	enregJournal_t *lot = NULL, *tmp;
+	int capaciteLot = 0, capacite, nb;
+	uint64_t numero;
+	struct timespec delai = {0, DELAI_JOURNAL_MS * 1000000L};
+	ssize_t n;
+
+	CHECK_ZERO(pthread_mutex_lock(&journal.verrou), "pthread_mutex_lock");
+	while (1) {
+		while (journal.nb == 0 && journal.compactages == journal.demandes)
+			CHECK_ZERO(pthread_cond_wait(&journal.aEcrire, &journal.verrou), "pthread_cond_wait");
+		// Regroupement : les modifications des prochaines millisecondes partagent le fdatasync
+		CHECK_ZERO(pthread_mutex_unlock(&journal.verrou), "pthread_mutex_unlock");
+		nanosleep(&delai, NULL);
+		CHECK_ZERO(pthread_mutex_lock(&journal.verrou), "pthread_mutex_lock");
+		tmp = lot; lot = journal.tampon; journal.tampon = tmp;
+		nb = journal.nb; journal.nb = 0;
+		capacite = capaciteLot; capaciteLot = journal.capacite; journal.capacite = capacite;
+		numero = journal.numero;
+		CHECK_ZERO(pthread_mutex_unlock(&journal.verrou), "pthread_mutex_unlock");
 
+		for (char *p = (char *)lot, *fin = (char *)(lot + nb); p < fin; p += n)
+			CHECK(n = write(journal.fd, p, fin - p), "--write()--");
+		if (nb > 0) CHECK(fdatasync(journal.fd), "--fdatasync()--");
 
+		CHECK_ZERO(pthread_mutex_lock(&journal.verrou), "pthread_mutex_lock");
+		journal.numeroDurable = numero;
+		journal.nbEnreg += nb;
+		if (journal.nbEnreg >= MAX_JOURNAL_USERS || journal.compactages != journal.demandes) {
+			unsigned int demandes = journal.demandes;
+			compacter();
+			journal.compactages = demandes;
+		}
+		CHECK_ZERO(pthread_cond_broadcast(&journal.ecrit), "pthread_cond_broadcast");
+	}
+	return NULL;
+}
+/**
+ *	\fn			static int chargerAncien(const void *p, off_t taille)
+ *	\brief		Crée les utilisateurs d'un FICHIER_USERS de la première version (tableau de user_t)
+ *	\return		0, -1 si le contenu n'est pas dans ce format
+ */
+static int chargerAncien(const void *p, off_t taille) {
+	const enregAncien_t *enreg = p;
+	long nb = taille / sizeof(enregAncien_t);
 
+	if (taille % sizeof(enregAncien_t) != 0) return -1;
+	for (long i = 0; i < nb; i++)
+		if (memchr(enreg[i].name, '\0', MAX_NAME) == NULL) return -1;
+	for (long i = 0; i < nb; i++)
+		if (enreg[i].name[0] != '\0' && trouverUser((char *)enreg[i].name) == -1
+			&& creerUser((char *)enreg[i].name, NULL) == -1) break;
+	return 0;
+}
+/**
+ *	\fn			static int chargerInstantane(void)
+ *	\brief		Crée les utilisateurs de l'instantané, projeté en mémoire
+ *	\return		1 si FICHIER_USERS était dans le format de la première version (il doit être
+ *				réécrit), 0 sinon
+ *	\note		Un fichier illisible arrête le programme plutôt que d'être écrasé au
+ *				prochain compactage avec tous ses utilisateurs
+ */
+static int chargerInstantane(void) {
+	const enteteUsers_t *entete;
+	const enregUser_t *enreg;
+	struct stat st;
+	name_t nom = "";
+	void *p;
+	int fd, ancien = 0;
 
+	if ((fd = open(FICHIER_USERS, O_RDONLY)) == -1) return 0;	// première exécution
+	CHECK(fstat(fd, &st), "--fstat()--");
+	if (st.st_size == 0) { CHECK(close(fd), "--close()--"); return 0; }
+	CHECK_NULL((p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED ? NULL : p, "--mmap()--");
+	madvise(p, st.st_size, MADV_SEQUENTIAL);
+	entete = p;
+	enreg = (const enregUser_t *)(entete + 1);
+	if (st.st_size >= sizeof(enteteUsers_t) && memcmp(entete->magique, MAGIQUE_USERS, 4) == 0
+		&& entete->version == VERSION_USERS && entete->tailleEnreg == sizeof(enregUser_t)
+		&& st.st_size >= sizeof(enteteUsers_t) + (off_t)entete->nb * sizeof(enregUser_t)) {
+		for (uint32_t i = 0; i < entete->nb; i++) {
+			strncpy(nom, enreg[i].name, MAX_NAME-1);
+			if (nom[0] != '\0' && creerUser(nom, NULL) == -1) break;
+		}
+	}
+	else if (chargerAncien(p, st.st_size) == 0) {
+		fprintf(stderr, "%s : ancien format, converti\n", FICHIER_USERS);
+		ancien = 1;
+	}
+	else {
+		fprintf(stderr, "%s : format inconnu, fichier conservé : arrêt\n", FICHIER_USERS);
+		exit(-1);
+	}
+	CHECK(munmap(p, st.st_size), "--munmap()--");
+	CHECK(close(fd), "--close()--");
+	return ancien;
+}
+/**
+ *	\fn			static long rejouerJournal(const char *fichier)
+ *	\brief		Rejoue un journal jusqu'au premier enregistrement incomplet, qui est tronqué
+ *	\return		Nombre d'enregistrements valides
+ */
+static long rejouerJournal(const char *fichier) {
+	enregJournal_t e;
+	uint32_t somme;
+	long nb = 0;
+	int index;
+	FILE *fp;
 
+	if ((fp = fopen(fichier, "r+")) == NULL) return 0;
+	while (fread(&e, sizeof(e), 1, fp) == 1) {
+		somme = e.somme;
+		e.somme = 0;
+		if (somme != sommeControle(&e, sizeof(e)) || (e.op != OP_CREER && e.op != OP_SUPPRIMER)) break;
+		e.name[MAX_NAME-1] = '\0';
+		index = trouverUser(e.name);
+		if (e.op == OP_CREER && index == -1) creerUser(e.name, NULL);
+		if (e.op == OP_SUPPRIMER && index != -1) supprimerUser(index);
+		if (e.numero > journal.numero) journal.numero = e.numero;
+		nb++;
+	}
+	// Écriture interrompue par un arrêt brutal : la fin du journal est abandonnée
+	CHECK(ftruncate(fileno(fp), nb * sizeof(enregJournal_t)), "--ftruncate()--");
+	CHECK(fclose(fp), "--fclose()--");
+	return nb;
+}
 
+void lireUsers(void) {
+	pthread_t th;
+	int fd, ancien;
 
+	if (journal.fd != -1) return;
+	ancien = chargerInstantane();
+	if (access(JOURNAL_USERS ".old", F_OK) == 0) {
+		// Compactage interrompu : l'ancien journal est rejoué puis intégré à un nouvel instantané,
+		// il n'est supprimé que si cet instantané est complet
+		rejouerJournal(JOURNAL_USERS ".old");
+		journal.nbEnreg = rejouerJournal(JOURNAL_USERS);
+		if (ecrireInstantane() == 0) { CHECK(unlink(JOURNAL_USERS ".old"), "--unlink()--"); }
+		else journal.ancienConserve = 1;
+	}
+	else {
+		journal.nbEnreg = rejouerJournal(JOURNAL_USERS);
+		// Ancien format : réécrit tout de suite, un échec laisse le fichier d'origine en place
+		if (ancien) ecrireInstantane();
+	}
+	journal.numeroDurable = journal.numero;
+	CHECK(fd = open(JOURNAL_USERS, O_WRONLY | O_CREAT | O_APPEND, 0644), "--open()--");
+	CHECK_ZERO(pthread_create(&th, NULL, ecrireJournal, NULL), "pthread_create");
+	CHECK_ZERO(pthread_detach(th), "pthread_detach");
+	__atomic_store_n(&journal.fd, fd, __ATOMIC_RELEASE);
+	//
+	TRACE_USERS("lire");
+}
+void synchroniserUsers(void) {
+	uint64_t numero;
 
+	if (__atomic_load_n(&journal.fd, __ATOMIC_ACQUIRE) == -1) return;
+	CHECK_ZERO(pthread_mutex_lock(&journal.verrou), "pthread_mutex_lock");
+	numero = journal.numero;
+	while (journal.numeroDurable < numero)
+		CHECK_ZERO(pthread_cond_wait(&journal.ecrit, &journal.verrou), "pthread_cond_wait");
+	CHECK_ZERO(pthread_mutex_unlock(&journal.verrou), "pthread_mutex_unlock");
+}
+void ecrireUsers(void) {
+	unsigned int demande;
 
+	if (__atomic_load_n(&journal.fd, __ATOMIC_ACQUIRE) == -1) {
+		CHECK(ecrireInstantane(), "--ecrireUsers()--");
+		return;
+	}
+	CHECK_ZERO(pthread_mutex_lock(&journal.verrou), "pthread_mutex_lock");
+	demande = ++journal.demandes;
+	CHECK_ZERO(pthread_cond_signal(&journal.aEcrire), "pthread_cond_signal");
+	while ((int)(journal.compactages - demande) < 0)
+		CHECK_ZERO(pthread_cond_wait(&journal.ecrit, &journal.verrou), "pthread_cond_wait");
+	CHECK_ZERO(pthread_mutex_unlock(&journal.verrou), "pthread_mutex_unlock");
+}